@@ -2,7 +2,8 @@
 
 #include <algorithm>
 #include <fstream>
-#include <thread>
+
+#include "GameLoop.h"
 
 Object::Object(int pos_x, int pos_y, int relative_speed)
     : pos_x(pos_x), pos_y(pos_y), relative_speed(relative_speed) {}
@@ -43,6 +44,7 @@ Road::Road()
       objects(),
       dist(0) {
     clear();
+    engine.resize_frame(frame_width, header_height + height);
     engine.clear();
 }
 std::vector<int> Road::free_pos() {
@@ -87,29 +89,42 @@ bool Road::update() {
             ++it;
         }
     }
+    bool is_colision = compose();
+    if (!is_colision) ++dist;
+    ++pending_scroll;
+    return is_colision;
+}
+// Собирает дорогу из машин и игрока, возвращает true при столкновении
+bool Road::compose() {
     clear();
     render_objs();
     bool is_colision = render_player();
     if (is_colision) {
         render_broken_player();
     }
-    if (!is_colision) ++dist;
     return is_colision;
 }
 void Road::clear() {
-    std::string empty_line(width, '.');  // строка из `width` точек
+    // Строки из `width` точек; assign не выделяет память заново
     for (auto& line : road) {
-        line = empty_line;
+        line.assign(width, '.');
     }
 }
 void Road::draw() {
-    engine.set_cursor_to_zero();
-
-    engine.print("Best score: ", max_dist, "\n");
-    engine.print("Score: ", dist, "\n");
-    for (auto& row : road) {
-        engine.print(row, "\n");
+    engine.draw_fmt<"Best score: {}">(0, 0, max_dist);
+    engine.draw_fmt<"Score: {}">(0, 1, dist);
+    for (int y = 0; y < height; ++y) {
+        engine.draw_text(0, header_height + y, road[y]);
     }
+    // За шаг дорога уезжает на строку вниз: строки над игроком может сдвинуть
+    // сам терминал, тогда машины той же скорости не перерисовываются
+    if (pending_scroll > 0) {
+        engine.suggest_scroll(header_height,
+                              header_height + player.get_pos_y() - 1,
+                              pending_scroll);
+        pending_scroll = 0;
+    }
+    engine.present();
 }
 void Road::render_objs() {
     for (auto& obj : objects) {
@@ -157,6 +172,16 @@ int Road::get_score() { return dist; }
 
 void Road::set_max_dist(int new_max_dist) { max_dist = new_max_dist; }
 
+bool Road::spectate(const std::string& path) {
+    return engine.start_spectators(path);
+}
+
+bool Road::record(const std::string& path) {
+    return engine.start_recording(path);
+}
+
+ConsoleEngine& Road::get_engine() { return engine; }
+
 std::random_device CarGenerator::rd;
 std::mt19937 CarGenerator::gen{CarGenerator::rd()};
 std::uniform_int_distribution<int> CarGenerator::dist(0, 8);
@@ -175,35 +200,42 @@ void CarGenerator::generate(Road& road) {
     }
 }
 
-void CarRacing::get_player_commands() {
+bool CarRacing::get_player_commands() {
+    int old_pos_x = road.player.get_pos_x();
+    ConsoleEngine& engine = road.get_engine();
     if (engine.key_pressed('A')) {
         road.player.set_pos_x(std::max(0, road.player.get_pos_x() - 1));
     } else if (engine.key_pressed('D')) {
         road.player.set_pos_x(std::min(road.width - road.player.width,
                                        road.player.get_pos_x() + 1));
     }
+    return road.player.get_pos_x() != old_pos_x;
 }
 
-CarRacing::CarRacing() : road(), engine() {}
+CarRacing::CarRacing() : road() {}
 CarRacing::~CarRacing() {}
-void CarRacing::play() {
+bool CarRacing::spectate(const std::string& path) {
+    return road.spectate(path);
+}
+bool CarRacing::record(const std::string& path) { return road.record(path); }
+void CarRacing::play(int max_frames) {
     road.set_max_dist(load_high_score());
     is_running = true;
-    auto last_frame = std::chrono::steady_clock::now();
-    while (is_running) {
-        get_player_commands();
-
-        auto now = std::chrono::steady_clock::now();
-        if (now - last_frame >= FRAME_DURATION) {
-            bool is_colision = road.update();
-            road.draw();
-            is_running = !is_colision;
-            last_frame = now;
-        }
-
-        // Маленькая пауза, чтобы не грузить CPU
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
+    GameLoop loop(FRAME_DURATION);
+    loop.attach_engine(road.get_engine());
+    loop.on_input([&] {
+        // Сдвиг игрока виден сразу, не дожидаясь следующего шага дороги
+        if (!get_player_commands()) return;
+        is_running = !road.compose();
+        loop.request_render();
+        if (!is_running) loop.stop();
+    });
+    loop.on_tick([&] {
+        is_running = !road.update();
+        if (!is_running) loop.stop();
+    });
+    loop.on_render([&] { road.draw(); });
+    loop.run(max_frames);
     save_high_score();
 }
 
@@ -3,7 +3,9 @@
 #include <chrono>
 #include <concepts>
 #include <list>
+#include <memory>
 #include <random>
+#include <string>
 #include <vector>
 
 #include "ConsoleEngine.h"
@@ -111,6 +113,8 @@ class Road {
   public:
     static constexpr int width = 5 * SpriteRepository::width;
     static constexpr int height = 5 * SpriteRepository::height;
+    static constexpr int header_height = 2;
+    static constexpr int frame_width = 32;
     Road();
     template <typename T>
         requires std::derived_from<T, Object>
@@ -118,6 +122,7 @@ class Road {
         objects.push_back(std::make_unique<T>(pos_x, pos_y));
     }
     bool update();
+    bool compose();
     void clear();
     void draw();
     void render_objs();
@@ -126,6 +131,11 @@ class Road {
     std::vector<int> free_pos();
     int get_score();
     void set_max_dist(int new_max_dist);
+    bool spectate(const std::string& path);
+    bool record(const std::string& path);
+    // Ввод читается тем же движком, что и рисует дорогу: так он попадает в
+    // журнал сеанса вместе с выводом
+    ConsoleEngine& get_engine();
 
     Player player;
 
@@ -135,6 +145,7 @@ class Road {
     std::array<std::string, height> road;
     int dist;
     int max_dist;
+    int pending_scroll = 0;
 };
 
 class CarGenerator {
@@ -151,7 +162,12 @@ class CarRacing {
   public:
     CarRacing();
     ~CarRacing();
-    void play();
+    // max_frames < 0 — играть до столкновения
+    void play(int max_frames = -1);
+    // Трансляция игры зрителям через Unix-сокет path
+    bool spectate(const std::string& path);
+    // Журнал сеанса в файл path
+    bool record(const std::string& path);
     void save_high_score();
     int load_high_score();
 
@@ -159,11 +175,9 @@ class CarRacing {
     static constexpr int max_x_move = 3;
     Road road;
     bool is_running;
-
-    ConsoleEngine engine;
     const std::chrono::milliseconds FRAME_DURATION =
         std::chrono::milliseconds(250);
     const std::string highscore_filename = "highscore.txt";
 
-    void get_player_commands();
+    bool get_player_commands();
 };
\ No newline at end of file
@@ -1,12 +1,31 @@
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
 
 #include "Game.h"
+#include "GameOptions.h"
+#include "HeadlessTerminal.h"
 
 int main(int argc, char* argv[]) {
+    std::optional<GameOptions> options =
+        GameOptions::parse(argc, argv, std::cerr);
+    if (!options) return 1;
+    ConsoleEngine::set_default_stats_options(options->stats);
+    if (options->headless_frames) {
+        // Лишняя строка — для строки статистики
+        HeadlessTerminal terminal(Road::frame_width,
+                                  Road::header_height + Road::height + 1);
+        ConsoleEngine::set_default_streams(std::cin, terminal.stream());
+        CarRacing game = CarRacing();
+        options->start_outputs(game, std::cerr);
+        game.play(*options->headless_frames);
+        terminal.write_report(std::cout);
+        return 0;
+    }
     CarRacing game = CarRacing();
+    options->start_outputs(game, std::cerr);
     game.play();
     return 0;
 }
\ No newline at end of file
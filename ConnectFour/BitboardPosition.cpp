@@ -0,0 +1,82 @@
+#include "BitboardPosition.h"
+
+#include <bit>
+
+#include "Zobrist.h"
+
+BitboardPosition::BitboardPosition(int width, int height)
+    : width_(width), height_(height) {
+    for (int col = 0; col < width; ++col) {
+        bottom_mask_ |= bottom_bit(col);
+        board_mask_ |= column_mask(col) & ~(bottom_bit(col) << height);
+    }
+}
+
+bool BitboardPosition::fits(int width, int height) {
+    return width * (height + 1) <= 64;
+}
+
+int BitboardPosition::get_width() const { return width_; }
+int BitboardPosition::get_height() const { return height_; }
+
+// Прибавление нижней клетки переносом поднимается по занятым клеткам
+// колонки до первой свободной; у заполненной колонки перенос уходит в
+// служебную строку, которую срезает board_mask_
+uint64_t BitboardPosition::legal_moves() const {
+    return (mask_ + bottom_mask_) & board_mask_;
+}
+
+bool BitboardPosition::can_play(int col) const {
+    return !(mask_ & (bottom_bit(col) << (height_ - 1)));
+}
+
+bool BitboardPosition::is_full() const { return legal_moves() == 0; }
+
+int BitboardPosition::get_free_cells() const {
+    return std::popcount(board_mask_ & ~mask_);
+}
+
+uint64_t BitboardPosition::get_hash() const { return hash_; }
+
+void BitboardPosition::play(int col, Participant p) {
+    uint64_t cell = (mask_ + bottom_bit(col)) & column_mask(col);
+    players_[static_cast<int>(p)] |= cell;
+    mask_ |= cell;
+    hash_ ^= Zobrist::key(p, std::countr_zero(cell));
+}
+
+void BitboardPosition::undo(int col) {
+    uint64_t cell = ((mask_ & column_mask(col)) + bottom_bit(col)) >> 1;
+    Participant p = (players_[0] & cell) ? Participant::player1
+                                         : Participant::player2;
+    hash_ ^= Zobrist::key(p, std::countr_zero(cell));
+    players_[0] &= ~cell;
+    players_[1] &= ~cell;
+    mask_ &= ~cell;
+}
+
+bool BitboardPosition::is_winning(int col) const {
+    uint64_t top = ((mask_ & column_mask(col)) + bottom_bit(col)) >> 1;
+    uint64_t pieces = (players_[0] & top) ? players_[0] : players_[1];
+    return has_four(pieces, height_ + 1);
+}
+
+uint64_t BitboardPosition::column_mask(int col) const {
+    return ((uint64_t{1} << (height_ + 1)) - 1) << (col * (height_ + 1));
+}
+
+uint64_t BitboardPosition::bottom_bit(int col) const {
+    return uint64_t{1} << (col * (height_ + 1));
+}
+
+// Сдвиг на 1 — соседняя клетка по вертикали, на column_bits — по
+// горизонтали, на column_bits -+ 1 — по диагоналям. pairs отмечает две
+// фишки подряд, две пары через одну клетку — четыре
+bool BitboardPosition::has_four(uint64_t pieces, int column_bits) {
+    const int shifts[4] = {1, column_bits, column_bits - 1, column_bits + 1};
+    for (int shift : shifts) {
+        uint64_t pairs = pieces & (pieces >> shift);
+        if (pairs & (pairs >> (2 * shift))) return true;
+    }
+    return false;
+}
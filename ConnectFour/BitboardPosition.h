@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+
+#include "Position.h"
+
+// Позиция для поиска на битовых масках: по маске фишек на игрока и маска
+// занятых клеток. Колонка занимает height + 1 бит снизу вверх; лишний
+// верхний бит всегда пуст и не даёт сдвигам переходить между колонками,
+// поэтому поле должно укладываться в 64 бита: width * (height + 1) <= 64.
+// Интерфейс совпадает с Position, поиск работает с обеими
+class BitboardPosition {
+  public:
+    BitboardPosition(int width, int height);
+    static bool fits(int width, int height);
+
+    int get_width() const;
+    int get_height() const;
+    // Нижняя свободная клетка каждой незаполненной колонки
+    uint64_t legal_moves() const;
+    bool can_play(int col) const;
+    bool is_full() const;
+    int get_free_cells() const;
+    // Хеш Zobrist (Zobrist.h) по номерам битов, обновляется при каждом ходе
+    uint64_t get_hash() const;
+
+    void play(int col, Participant p);
+    // Отменяет последний ход в колонке col
+    void undo(int col);
+    // Составляет ли верхняя фишка колонки col четвёрку
+    bool is_winning(int col) const;
+
+  private:
+    uint64_t column_mask(int col) const;
+    uint64_t bottom_bit(int col) const;
+    static bool has_four(uint64_t pieces, int column_bits);
+
+    int width_;
+    int height_;
+    uint64_t players_[2] = {0, 0};
+    uint64_t mask_ = 0;
+    uint64_t hash_ = 0;
+    // Нижние клетки всех колонок и все клетки поля без служебной строки
+    uint64_t bottom_mask_ = 0;
+    uint64_t board_mask_ = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<BitboardPosition>);
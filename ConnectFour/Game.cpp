@@ -1,20 +1,11 @@
 #include "Game.h"
 
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 
-char to_char(Participant p) {
-    switch (p) {
-        case Participant::player1:
-            return '*';
-        case Participant::player2:
-            return 'O';
-        case Participant::none:
-            return ' ';
-    }
-    return '?';
-}
-
 Board::Board(int width, int height)
     : width(width),
       height(height),
@@ -39,21 +30,18 @@ int Board::get_new_cursor_pos(int cursor) {
 }
 
 void Board::draw(int cursor) {
+    engine.begin_frame();
     engine.clear();
     draw_cursor(cursor);
     draw_board();
+    engine.end_frame();
 }
 
 void Board::draw_cursor(int cursor) {
-    for (int i = 0; i <= cursor * 2; ++i) {
-        engine.print(' ');
-    }
-    engine.print('v');  // TODO: рассмотреть возможность смены цвета или самого
-                        // курсора для разных игроков
-    for (int i = cursor * 2; i <= (width + 1) * 2; ++i) {
-        engine.print(' ');
-    }
-    engine.print('\n');
+    // TODO: рассмотреть возможность смены цвета или самого курсора для разных
+    // игроков
+    engine.print_fmt<"{:>{}}{:{}}\n">('v', cursor * 2 + 2, "",
+                                      (width + 1 - cursor) * 2 + 1);
 }
 
 void Board::draw_board() {
@@ -74,16 +62,6 @@ bool Board::try_add_piece(int cursor, Participant p) {
     return true;
 }
 
-Board Board::add_piece_to_new(int cursor, Participant p) {
-    if (is_col_fill(cursor)) return *this;
-    Board new_board = *this;
-    int row = 0;
-    while (row < height && new_board.board[row][cursor] == Participant::none)
-        ++row;
-    new_board.board[row - 1][cursor] = p;
-    return new_board;
-}
-
 void Board::set_winner(Participant p) {
     // engine.clear();
     if (p == Participant::player1)
@@ -219,6 +197,15 @@ ConnectFour::ConnectFour(int width, int height, std::unique_ptr<Player> player1,
       player1(std::move(player1)),
       player2(std::move(player2)) {
     std::srand(std::time(nullptr));
+    // Иначе компьютер на большом поле молча ходил бы случайно
+    if (!this->player1->supports_board(width, height) ||
+        !this->player2->supports_board(width, height)) {
+        std::cerr << "Board " << width << "x" << height
+                  << " is too large for minimax and search players, at most "
+                  << Position::max_width << "x" << Position::max_height
+                  << "\n";
+        throw std::runtime_error("Board too large for computer player");
+    }
 }
 
 ConnectFour ConnectFour::HumanVsComputer(int width, int height,
@@ -277,10 +264,29 @@ void ConnectFour::play() {
 
 Player::Player(Participant participant) : participant(participant) {}
 
+bool Player::supports_board(int, int) const { return true; }
+
 HumanPlayer::HumanPlayer(Participant p) : Player(p) {}
 
+std::ostream* ComputerPlayer::search_log = nullptr;
+
 ComputerPlayer::ComputerPlayer(Participant p, ComputeParams params)
-    : Player(p), compute_params(params) {}
+    : Player(p),
+      compute_params(params),
+      search(p, params) {}
+
+bool ComputerPlayer::supports_board(int width, int height) const {
+    return compute_params.move_type == MoveTypes::random ||
+           Position::fits(width, height);
+}
+
+void ComputerPlayer::set_search_log(std::ostream* log) {
+    search_log = log;
+    if (search_log) {
+        *search_log << "player,column,depth,nodes,time_us,tt_probes,tt_hits,"
+                       "tt_hit_rate,tt_bytes\n";
+    }
+}
 
 void HumanPlayer::move(Board& board) {
     bool valid_move = false;
@@ -296,6 +302,7 @@ void ComputerPlayer::move(Board& board) {
             random_move(board);
             break;
         case MoveTypes::minimax:
+        case MoveTypes::search:
             minimax_move(board);
             break;
         default:
@@ -313,67 +320,103 @@ void ComputerPlayer::random_move(Board& board) {
     }
 }
 
-ComputerPlayer::MoveResult ComputerPlayer::calculate_next_move(
-    Board board, Participant p, int depth, int alpha, int beta) {
-    Participant winner = board.check_win();
-    if (winner != Participant::none) {
-        int base_score = (winner == participant) ? 1 : -1;
-        int scaled_score = base_score * (1000 - depth + 1);
-        return {scaled_score, -1};
+void ComputerPlayer::minimax_move(Board& board) {
+    // Поле до 64 клеток со служебной строкой помещается в битовые маски,
+    // большее — в Position; поле больше неё отклоняет конструктор игры
+    Search::MoveResult next_check{0, -1};
+    if (BitboardPosition::fits(board.width, board.height)) {
+        next_check =
+            search.find_move(board.get_position<BitboardPosition>());
+    } else if (Position::fits(board.width, board.height)) {
+        next_check = search.find_move(board.get_position<Position>());
     }
+    log_search(next_check.column);
+    if (next_check.column != -1)
+        board.try_add_piece(next_check.column, participant);
+    else
+        random_move(board);
+}
 
-    if (compute_params.max_depth != -1 and depth > compute_params.max_depth)
-        return {0, -1};
-    if (board.is_fill()) return {0, -1};
-
-    bool is_maximizing = (p == participant);
-    int best_score = is_maximizing ? -1000 : +1000;
-    int best_move = -1;
-
-    for (int i = 0; i < board.width; ++i) {
-        if (board.is_col_fill(i)) continue;
+void ComputerPlayer::log_search(int column) const {
+    if (!search_log) return;
+    Search::Stats stats = search.get_stats();
+    double hit_rate =
+        stats.probes ? static_cast<double>(stats.hits) / stats.probes : 0.0;
+    *search_log << (participant == Participant::player1 ? 1 : 2) << ','
+                << column << ',' << search.get_completed_depth() << ','
+                << stats.nodes << ','
+                << std::chrono::duration_cast<std::chrono::microseconds>(
+                       search.get_elapsed())
+                       .count()
+                << ',' << stats.probes << ',' << stats.hits << ',' << hit_rate
+                << ',' << search.get_table().get_memory() << '\n';
+}
 
-        auto next_check = calculate_next_move(board.add_piece_to_new(i, p),
-                                              p == Participant::player1
-                                                  ? Participant::player2
-                                                  : Participant::player1,
-                                              depth + 1, alpha, beta);
-        if (is_maximizing) {
-            if (next_check.score > best_score) {
-                best_score = next_check.score;
-                best_move = i;  // TODO: почти сразу инициализируется 0, поэтому
-                                // если достигнута глубина просчета - вернет 0
+namespace {
+// Настройки после типа игрока через запятую:
+// "minimax:8,tt=64,order=0,threads=4"
+void apply_compute_options(const std::string& options,
+                           ComputeParams& params) {
+    size_t start = 0;
+    while (start < options.size()) {
+        size_t end = options.find(',', start);
+        if (end == std::string::npos) end = options.size();
+        std::string option = options.substr(start, end - start);
+        start = end + 1;
+        try {
+            if (option.rfind("tt=", 0) == 0) {
+                params.table_mb = std::stoul(option.substr(3));
+                continue;
+            }
+            if (option == "order=0" || option == "order=1") {
+                params.move_ordering = option.back() == '1';
+                continue;
             }
-            alpha = std::max(alpha, best_score);
-        } else {
-            if (next_check.score < best_score) {
-                best_score = next_check.score;
-                best_move = i;
+            if (option.rfind("threads=", 0) == 0) {
+                int threads = std::stoi(option.substr(8));
+                if (threads >= 1) {
+                    params.threads = threads;
+                    continue;
+                }
             }
-            beta = std::min(beta, best_score);
+        } catch (...) {
         }
-
-        if (beta <= alpha) break;
+        std::cerr << "Invalid player option: " << option << "\n";
     }
-    return {best_score, best_move};
-}
-
-void ComputerPlayer::minimax_move(Board& board) {
-    auto next_check = calculate_next_move(board, participant, 0);
-    if (next_check.column != -1)
-        board.try_add_piece(next_check.column, participant);
-    else
-        random_move(board);
 }
+}  // namespace
 
 std::unique_ptr<Player> player_from_string(std::string params, Participant p) {
     if (params == "human") {
         return std::make_unique<HumanPlayer>(p);
     }
     if (params.rfind("minimax:", 0) == 0) {
-        int depth = std::stoi(params.substr(8));
-        return std::make_unique<ComputerPlayer>(
-            p, ComputeParams{MoveTypes::minimax, depth});
+        size_t comma = params.find(',');
+        ComputeParams compute{MoveTypes::minimax,
+                              std::stoi(params.substr(8, comma - 8))};
+        if (comma != std::string::npos)
+            apply_compute_options(params.substr(comma + 1), compute);
+        return std::make_unique<ComputerPlayer>(p, compute);
+    }
+    if (params.rfind("search:", 0) == 0) {
+        // Время: "500ms" или "2s"
+        size_t comma = params.find(',');
+        std::string budget = params.substr(7, comma - 7);
+        size_t digits = 0;
+        long long amount = 0;
+        try {
+            amount = std::stoll(budget, &digits);
+        } catch (...) {
+        }
+        std::string unit = budget.substr(digits);
+        if (amount > 0 && (unit == "ms" || unit == "s")) {
+            ComputeParams compute{MoveTypes::search, -1};
+            compute.time_budget = std::chrono::milliseconds(
+                unit == "s" ? amount * 1000 : amount);
+            if (comma != std::string::npos)
+                apply_compute_options(params.substr(comma + 1), compute);
+            return std::make_unique<ComputerPlayer>(p, compute);
+        }
     }
     if (params.rfind("random", 0) == 0) {
         return std::make_unique<ComputerPlayer>(
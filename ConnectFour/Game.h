@@ -1,21 +1,14 @@
 #pragma once
 #include <memory>
+#include <ostream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "BitboardPosition.h"
 #include "ConsoleEngine.h"
-
-enum class MoveTypes { random, minimax };
-
-enum class Participant { player1, player2, none };
-
-char to_char(Participant p);
-
-struct ComputeParams {
-    MoveTypes move_type = MoveTypes::minimax;
-    int max_depth = 6;
-};
+#include "Position.h"
+#include "Search.h"
 
 class Board {
   public:
@@ -26,7 +19,18 @@ class Board {
     void draw(int cursor);
     int get_new_cursor_pos(int cursor);
     bool try_add_piece(int cursor, Participant p);
-    Board add_piece_to_new(int cursor, Participant p);
+    // PositionType — Position или BitboardPosition
+    template <typename PositionType>
+    PositionType get_position() const {
+        PositionType position(width, height);
+        for (int col = 0; col < width; ++col) {
+            for (int row = height - 1;
+                 row >= 0 && board[row][col] != Participant::none; --row) {
+                position.play(col, board[row][col]);
+            }
+        }
+        return position;
+    }
     void set_winner(Participant p);
 
     Participant check_win();
@@ -52,28 +56,31 @@ class Player {
     Player(Participant participant);
     virtual ~Player() = default;
     virtual void move(Board& board) = 0;
+    // Может ли игрок играть на поле такого размера
+    virtual bool supports_board(int width, int height) const;
 
   protected:
     Participant participant;
 };
 
 class ComputerPlayer : public Player {
-    struct MoveResult {
-        int score;
-        int column;
-    };
-
   public:
     ComputerPlayer(Participant participant,
                    ComputeParams params = ComputeParams{MoveTypes::minimax, 6});
     void move(Board& board) override;
+    // minimax и search ищут ход на поле до Position::max_width x max_height
+    bool supports_board(int width, int height) const override;
+    // Куда писать CSV со статистикой поиска после каждого хода;
+    // nullptr — никуда. Поток должен жить, пока идёт игра
+    static void set_search_log(std::ostream* log);
 
   private:
     ComputeParams compute_params;
+    Search search;
+    static std::ostream* search_log;
     void random_move(Board& board);
     void minimax_move(Board& board);
-    MoveResult calculate_next_move(Board board, Participant p, int depth,
-                                   int alpha = INT_MIN, int beta = INT_MAX);
+    void log_search(int column) const;
 };
 
 class HumanPlayer : public Player {
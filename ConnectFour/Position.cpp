@@ -0,0 +1,86 @@
+#include "Position.h"
+
+#include "Zobrist.h"
+
+char to_char(Participant p) {
+    switch (p) {
+        case Participant::player1:
+            return '*';
+        case Participant::player2:
+            return 'O';
+        case Participant::none:
+            return ' ';
+    }
+    return '?';
+}
+
+Participant opponent(Participant p) {
+    return p == Participant::player1 ? Participant::player2
+                                     : Participant::player1;
+}
+
+Position::Position(int width, int height) : width_(width), height_(height) {
+    cells_.fill(Participant::none);
+}
+
+bool Position::fits(int width, int height) {
+    return width <= max_width && height <= max_height;
+}
+
+int Position::get_width() const { return width_; }
+int Position::get_height() const { return height_; }
+
+Participant Position::at(int col, int row) const {
+    return cells_[row * max_width + col];
+}
+
+bool Position::can_play(int col) const { return heights_[col] < height_; }
+
+bool Position::is_full() const { return moves_ == width_ * height_; }
+
+int Position::get_free_cells() const { return width_ * height_ - moves_; }
+
+uint64_t Position::get_hash() const { return hash_; }
+
+void Position::play(int col, Participant p) {
+    int cell = heights_[col]++ * max_width + col;
+    cells_[cell] = p;
+    hash_ ^= Zobrist::key(p, cell);
+    ++moves_;
+}
+
+void Position::undo(int col) {
+    int cell = --heights_[col] * max_width + col;
+    hash_ ^= Zobrist::key(cells_[cell], cell);
+    cells_[cell] = Participant::none;
+    --moves_;
+}
+
+// Фишек p подряд от (col, row) в направлении (dx, dy), не считая начальной
+int Position::count_run(int col, int row, int dx, int dy,
+                        Participant p) const {
+    int count = 0;
+    col += dx;
+    row += dy;
+    while (col >= 0 && col < width_ && row >= 0 && row < height_ &&
+           at(col, row) == p) {
+        ++count;
+        col += dx;
+        row += dy;
+    }
+    return count;
+}
+
+// До хода в колонку четвёрок на поле не было, поэтому достаточно проверить
+// линии через новую фишку
+bool Position::is_winning(int col) const {
+    int row = heights_[col] - 1;
+    Participant p = at(col, row);
+    constexpr int directions[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+    for (const auto& [dx, dy] : directions) {
+        int length = 1 + count_run(col, row, dx, dy, p) +
+                     count_run(col, row, -dx, -dy, p);
+        if (length >= 4) return true;
+    }
+    return false;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+enum class Participant : uint8_t { player1, player2, none };
+
+char to_char(Participant p);
+Participant opponent(Participant p);
+
+// Позиция для поиска: клетки лежат в массиве фиксированного размера, поэтому
+// копия — это memcpy, а ход делается и отменяется на месте без выделений.
+// Board остаётся только отображением партии. Строки считаются снизу.
+// Поиск берёт её для полей, не помещающихся в BitboardPosition
+class Position {
+  public:
+    static constexpr int max_width = 16;
+    static constexpr int max_height = 16;
+
+    Position(int width, int height);
+    static bool fits(int width, int height);
+
+    int get_width() const;
+    int get_height() const;
+    Participant at(int col, int row) const;
+    bool can_play(int col) const;
+    bool is_full() const;
+    int get_free_cells() const;
+    // Хеш Zobrist (Zobrist.h), обновляется при каждом ходе
+    uint64_t get_hash() const;
+
+    void play(int col, Participant p);
+    // Отменяет последний ход в колонке col
+    void undo(int col);
+    // Составляет ли верхняя фишка колонки col четвёрку
+    bool is_winning(int col) const;
+
+  private:
+    int count_run(int col, int row, int dx, int dy, Participant p) const;
+
+    int width_;
+    int height_;
+    int moves_ = 0;
+    uint64_t hash_ = 0;
+    std::array<uint8_t, max_width> heights_{};
+    std::array<Participant, max_width * max_height> cells_;
+};
+
+static_assert(std::is_trivially_copyable_v<Position>);
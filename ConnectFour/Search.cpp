@@ -0,0 +1,290 @@
+#include "Search.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+#include "BitboardPosition.h"
+
+namespace {
+// Оценка выигрыша зависит от глубины от корня, а одна позиция встречается
+// на разной глубине и в поисках разных ходов. Поэтому в таблице выигрыш
+// считается от самой позиции
+constexpr int win_threshold = 500;
+
+int score_to_table(int score, int depth) {
+    if (score > win_threshold) return score + depth;
+    if (score < -win_threshold) return score - depth;
+    return score;
+}
+
+int score_from_table(int score, int depth) {
+    if (score > win_threshold) return score - depth;
+    if (score < -win_threshold) return score + depth;
+    return score;
+}
+
+// Выше этого история делится пополам, чтобы не переполниться
+constexpr int history_limit = 1 << 24;
+}  // namespace
+
+Search::Search(Participant player, ComputeParams params)
+    : player(player),
+      params(params),
+      table(params.move_type == MoveTypes::random ? 0 : params.table_mb),
+      workers(std::max(params.threads, 1)) {
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].id = static_cast<int>(i);
+    }
+}
+
+Search::Stats Search::get_stats() const {
+    Stats total;
+    for (const Worker& worker : workers) {
+        total.nodes += worker.stats.nodes;
+        total.probes += worker.stats.probes;
+        total.hits += worker.stats.hits;
+    }
+    return total;
+}
+
+int Search::get_completed_depth() const { return completed_depth; }
+Search::Clock::duration Search::get_elapsed() const { return elapsed; }
+const TranspositionTable& Search::get_table() const { return table; }
+
+int Search::win_score(Participant p, int depth) const {
+    int base_score = (p == player) ? 1 : -1;
+    return base_score * (1000 - depth + 1);
+}
+
+template <typename PositionType>
+Search::MoveResult Search::find_move(const PositionType& position) {
+    auto start = Clock::now();
+    deadline = start + params.time_budget;
+    table.new_search();
+    stop.store(false, std::memory_order_relaxed);
+    int width = position.get_width();
+    for (int i = 0; i < width; ++i) {
+        center_order[i] = width / 2 + ((i & 1) ? -(i + 1) / 2 : i / 2);
+    }
+    for (Worker& worker : workers) {
+        worker.stats = Stats{};
+        worker.completed_depth = -1;
+        worker.best = MoveResult{0, -1};
+        worker.root_first_move = -1;
+        worker.check_time = worker.stopped = false;
+        worker.killers.fill({-1, -1});
+        worker.history = {};
+    }
+
+    // minimax тоже углубляется по итерациям: с таблицей позиций это дешевле
+    // одного прохода на полную глубину, а один поток считает то же, что и
+    // каждый из нескольких
+    Worker& main = workers[0];
+    int max_depth =
+        params.move_type == MoveTypes::search ? -1 : params.max_depth;
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < workers.size(); ++i) {
+        helpers.emplace_back([this, &position, max_depth, i] {
+            iterate(workers[i], position, max_depth);
+        });
+    }
+    iterate(main, position, max_depth);
+    stop.store(true, std::memory_order_relaxed);
+    for (std::thread& helper : helpers) helper.join();
+
+    const Worker* chosen = &main;
+    for (const Worker& worker : workers) {
+        if (worker.completed_depth > chosen->completed_depth &&
+            worker.best.column != -1)
+            chosen = &worker;
+    }
+    completed_depth = chosen->completed_depth;
+    elapsed = Clock::now() - start;
+    return chosen->best;
+}
+
+// Итерации с таблицей позиций дёшевы: большая часть дерева прошлой
+// глубины находится в ней. Нечётные вспомогательные потоки идут на одну
+// глубину впереди, и каждый вспомогательный начинает со своей колонки
+template <typename PositionType>
+void Search::iterate(Worker& worker, PositionType position, int max_depth) {
+    int last = position.get_free_cells() - 1;
+    if (max_depth != -1) last = std::min(last, max_depth);
+    if (worker.id != 0) {
+        worker.root_first_move =
+            center_order[worker.id % position.get_width()];
+        if (!position.can_play(worker.root_first_move))
+            worker.root_first_move = -1;
+    }
+    bool timed = params.move_type == MoveTypes::search;
+    for (int depth = worker.id % 2; depth <= last; ++depth) {
+        worker.search_depth = depth;
+        // Первая итерация основного потока доводится до конца всегда,
+        // чтобы ход был и при очень малом времени
+        worker.check_time = timed && (worker.id != 0 || depth > 0);
+        MoveResult result = calculate_next_move(worker, position, player, 0);
+        if (worker.stopped) break;
+        worker.best = result;
+        worker.completed_depth = depth;
+        worker.root_first_move = result.column;
+        // Выигрыш или проигрыш уже найден: глубже он не изменится
+        if (std::abs(result.score) > win_threshold) break;
+        if (timed && Clock::now() >= deadline) break;
+    }
+}
+
+// Часы и общий флаг дороже узла, поэтому проверяются раз в 1024 узла
+bool Search::should_stop(Worker& worker) const {
+    if (worker.stopped || (worker.stats.nodes & 1023) != 0)
+        return worker.stopped;
+    if ((worker.id != 0 && stop.load(std::memory_order_relaxed)) ||
+        (worker.check_time && Clock::now() >= deadline))
+        worker.stopped = true;
+    return worker.stopped;
+}
+
+// Ход из таблицы, затем killer-ходы этой глубины, затем по истории; при
+// равенстве ближняя к центру колонка раньше: через центр проходит больше
+// четвёрок
+template <typename PositionType>
+int Search::order_moves(const Worker& worker, const PositionType& position,
+                        Participant p, int depth, int hash_move,
+                        MoveList& moves) const {
+    int count = 0;
+    if (!params.move_ordering) {
+        if (hash_move != -1) moves[count++] = hash_move;
+        for (int col = 0; col < position.get_width(); ++col) {
+            if (col != hash_move && position.can_play(col))
+                moves[count++] = static_cast<int8_t>(col);
+        }
+        return count;
+    }
+
+    std::array<int, Position::max_width> scores;
+    const auto& history_p = worker.history[static_cast<int>(p)];
+    for (int k = 0; k < position.get_width(); ++k) {
+        int col = center_order[k];
+        if (!position.can_play(col)) continue;
+        int score = history_p[col];
+        if (col == worker.killers[depth][1]) score = INT_MAX - 2;
+        if (col == worker.killers[depth][0]) score = INT_MAX - 1;
+        if (col == hash_move) score = INT_MAX;
+        // Вставка с сохранением порядка равных: колонок не больше 16
+        int j = count++;
+        while (j > 0 && scores[j - 1] < score) {
+            scores[j] = scores[j - 1];
+            moves[j] = moves[j - 1];
+            --j;
+        }
+        scores[j] = score;
+        moves[j] = static_cast<int8_t>(col);
+    }
+    return count;
+}
+
+void Search::record_cutoff(Worker& worker, Participant p, int depth,
+                           int column, int remaining) const {
+    auto& killer = worker.killers[depth];
+    if (killer[0] != column) {
+        killer[1] = killer[0];
+        killer[0] = static_cast<int8_t>(column);
+    }
+    auto& history_p = worker.history[static_cast<int>(p)];
+    history_p[column] += remaining * remaining;
+    if (history_p[column] > history_limit) {
+        for (int& value : history_p) value /= 2;
+    }
+}
+
+// Ход делается в той же позиции и отменяется после оценки. Выигрыш
+// проверяется сразу после хода, поэтому в узел попадают только позиции без
+// четвёрки
+template <typename PositionType>
+Search::MoveResult Search::calculate_next_move(Worker& worker,
+                                               PositionType& position,
+                                               Participant p, int depth,
+                                               int alpha, int beta) {
+    ++worker.stats.nodes;
+    if (should_stop(worker)) return {0, -1};
+    if (worker.search_depth != -1 and depth > worker.search_depth)
+        return {0, -1};
+    if (position.is_full()) return {0, -1};
+
+    // Оставшаяся глубина: узлы глубже search_depth оцениваются нулём
+    int remaining = worker.search_depth == -1
+                        ? 255
+                        : worker.search_depth - depth + 1;
+    int alpha_start = alpha;
+    int beta_start = beta;
+    int hash_move = depth == 0 ? worker.root_first_move : -1;
+    if (table.is_enabled()) ++worker.stats.probes;
+    if (auto entry = table.probe(position.get_hash())) {
+        ++worker.stats.hits;
+        // Ход из записи проверяется: запись могла остаться от другой
+        // позиции с тем же индексом хеша
+        if (params.move_ordering && hash_move == -1 && entry->move >= 0 &&
+            entry->move < position.get_width() &&
+            position.can_play(entry->move))
+            hash_move = entry->move;
+        // В корне нужен ход, поэтому корень всегда ищется заново
+        if (depth > 0 && entry->depth >= remaining) {
+            int score = score_from_table(entry->score, depth);
+            using Bound = TranspositionTable::Bound;
+            if (entry->bound == Bound::Exact) return {score, entry->move};
+            if (entry->bound == Bound::Lower) alpha = std::max(alpha, score);
+            if (entry->bound == Bound::Upper) beta = std::min(beta, score);
+            if (beta <= alpha) return {score, entry->move};
+        }
+    }
+
+    bool is_maximizing = (p == player);
+    int best_score = is_maximizing ? -1000 : +1000;
+    int best_move = -1;
+
+    MoveList moves;
+    int count = order_moves(worker, position, p, depth, hash_move, moves);
+    for (int k = 0; k < count; ++k) {
+        int i = moves[k];
+        position.play(i, p);
+        MoveResult next_check =
+            position.is_winning(i)
+                ? MoveResult{win_score(p, depth + 1), -1}
+                : calculate_next_move(worker, position, opponent(p),
+                                      depth + 1, alpha, beta);
+        position.undo(i);
+        if (worker.stopped) return {0, -1};
+        if (is_maximizing) {
+            if (next_check.score > best_score) {
+                best_score = next_check.score;
+                best_move = i;  // TODO: почти сразу инициализируется 0, поэтому
+                                // если достигнута глубина просчета - вернет 0
+            }
+            alpha = std::max(alpha, best_score);
+        } else {
+            if (next_check.score < best_score) {
+                best_score = next_check.score;
+                best_move = i;
+            }
+            beta = std::min(beta, best_score);
+        }
+
+        if (beta <= alpha) {
+            record_cutoff(worker, p, depth, i, remaining);
+            break;
+        }
+    }
+
+    auto bound = TranspositionTable::Bound::Exact;
+    if (best_score <= alpha_start)
+        bound = TranspositionTable::Bound::Upper;
+    else if (best_score >= beta_start)
+        bound = TranspositionTable::Bound::Lower;
+    table.store(position.get_hash(), score_to_table(best_score, depth),
+                remaining, bound, best_move);
+    return {best_score, best_move};
+}
+
+template Search::MoveResult Search::find_move(const Position& position);
+template Search::MoveResult Search::find_move(
+    const BitboardPosition& position);
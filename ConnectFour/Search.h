@@ -0,0 +1,114 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Position.h"
+#include "TranspositionTable.h"
+
+enum class MoveTypes { random, minimax, search };
+
+struct ComputeParams {
+    MoveTypes move_type = MoveTypes::minimax;
+    int max_depth = 6;
+    // Для search: время на ход, глубина растёт, пока оно не выйдет
+    std::chrono::milliseconds time_budget{0};
+    // Размер таблицы позиций в МиБ, 0 — без таблицы
+    size_t table_mb = 16;
+    // Порядок ходов: ход из таблицы, killer-ходы, история, центр раньше
+    // краёв. Без него колонки перебираются слева направо
+    bool move_ordering = true;
+    // Потоков поиска; больше одного — Lazy SMP с общей таблицей позиций
+    int threads = 1;
+};
+
+// Альфа-бета поиск хода за игрока player. Работает с Position и
+// BitboardPosition; таблица позиций живёт между ходами.
+// С несколькими потоками каждый углубляет поиск сам, а общая таблица
+// позиций передаёт найденное между ними (Lazy SMP). Вспомогательные потоки
+// начинают с другой глубины и другого первого хода, чтобы не повторять
+// основной. Ход берётся из самой глубокой завершённой итерации, при
+// равенстве — основного потока, а не того, кто закончил раньше
+class Search {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct MoveResult {
+        int score;
+        int column;
+    };
+
+    struct Stats {
+        uint64_t nodes = 0;
+        uint64_t probes = 0;
+        uint64_t hits = 0;
+    };
+
+    Search(Participant player, ComputeParams params);
+
+    // column == -1 — хода нет
+    template <typename PositionType>
+    MoveResult find_move(const PositionType& position);
+
+    // Статистика последнего find_move, по всем потокам
+    Stats get_stats() const;
+    int get_completed_depth() const;
+    Clock::duration get_elapsed() const;
+    const TranspositionTable& get_table() const;
+
+  private:
+    static constexpr int max_ply = Position::max_width * Position::max_height;
+    using MoveList = std::array<int8_t, Position::max_width>;
+
+    // Состояние одного потока поиска; своя кеш-линия, чтобы счётчики
+    // соседних потоков не делили её
+    struct alignas(64) Worker {
+        int id = 0;
+        Stats stats;
+        // Глубина текущей итерации; -1 — без ограничения
+        int search_depth = 0;
+        int completed_depth = -1;
+        MoveResult best{0, -1};
+        // Лучший ход прошлой итерации; в корне пробуется первым
+        int root_first_move = -1;
+        bool check_time = false;
+        bool stopped = false;
+        // Два последних хода, вызвавших отсечение, на каждой глубине
+        std::array<std::array<int8_t, 2>, max_ply + 1> killers{};
+        // Насколько часто колонка вызывала отсечение, за каждого игрока
+        std::array<std::array<int, Position::max_width>, 2> history{};
+    };
+
+    template <typename PositionType>
+    void iterate(Worker& worker, PositionType position, int max_depth);
+    template <typename PositionType>
+    MoveResult calculate_next_move(Worker& worker, PositionType& position,
+                                   Participant p, int depth,
+                                   int alpha = INT_MIN, int beta = INT_MAX);
+    template <typename PositionType>
+    int order_moves(const Worker& worker, const PositionType& position,
+                    Participant p, int depth, int hash_move,
+                    MoveList& moves) const;
+    void record_cutoff(Worker& worker, Participant p, int depth, int column,
+                       int remaining) const;
+    // Оценка хода, которым p только что выиграл на глубине depth
+    int win_score(Participant p, int depth) const;
+    // Пора ли прервать итерацию: время вышло или основной поток закончил
+    bool should_stop(Worker& worker) const;
+
+    Participant player;
+    ComputeParams params;
+    TranspositionTable table;
+    std::vector<Worker> workers;
+    // Основной поток закончил: вспомогательные прерываются
+    std::atomic<bool> stop{false};
+    Clock::time_point deadline;
+    Clock::duration elapsed{0};
+    int completed_depth = 0;
+    // Колонки от центра к краям
+    MoveList center_order{};
+};
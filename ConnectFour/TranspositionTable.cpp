@@ -0,0 +1,93 @@
+#include "TranspositionTable.h"
+
+#include <algorithm>
+#include <bit>
+
+TranspositionTable::TranspositionTable(size_t size_mb) { resize(size_mb); }
+
+// Число корзин округляется вниз до степени двойки: индекс — младшие биты
+// ключа
+void TranspositionTable::resize(size_t size_mb) {
+    size_t count = size_mb * 1024 * 1024 / sizeof(Bucket);
+    bucket_count_ = count ? std::bit_floor(count) : 0;
+    buckets_ = bucket_count_ ? std::make_unique<Bucket[]>(bucket_count_)
+                             : nullptr;
+}
+
+void TranspositionTable::new_search() { ++generation_; }
+
+uint64_t TranspositionTable::pack(int score, int depth, Bound bound, int move,
+                                  uint8_t generation) {
+    return uint64_t{static_cast<uint16_t>(score)} |
+           uint64_t{static_cast<uint8_t>(std::clamp(depth, 1, 255))} << 16 |
+           uint64_t{static_cast<uint8_t>(bound)} << 24 |
+           uint64_t{static_cast<uint8_t>(move)} << 32 |
+           uint64_t{generation} << 40;
+}
+
+TranspositionTable::Entry TranspositionTable::unpack(uint64_t data) {
+    return Entry{static_cast<int16_t>(data & 0xffff), depth_of(data),
+                 static_cast<Bound>((data >> 24) & 0xff),
+                 static_cast<int8_t>((data >> 32) & 0xff)};
+}
+
+int TranspositionTable::depth_of(uint64_t data) {
+    return static_cast<int>((data >> 16) & 0xff);
+}
+
+uint8_t TranspositionTable::generation_of(uint64_t data) {
+    return static_cast<uint8_t>(data >> 40);
+}
+
+TranspositionTable::Bucket& TranspositionTable::bucket_for(
+    uint64_t key) const {
+    return buckets_[key & (bucket_count_ - 1)];
+}
+
+std::optional<TranspositionTable::Entry> TranspositionTable::probe(
+    uint64_t key) const {
+    if (!buckets_) return std::nullopt;
+    for (const Slot& slot : bucket_for(key).slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if (depth_of(data) != 0 && (check ^ data) == key) return unpack(data);
+    }
+    return std::nullopt;
+}
+
+// Два потока могут одновременно выбрать один слот; тогда останется одна
+// из записей, а смешанная не пройдёт проверку ключа
+void TranspositionTable::store(uint64_t key, int score, int depth,
+                               Bound bound, int move) {
+    if (!buckets_) return;
+    Slot* slots = bucket_for(key).slots;
+    auto priority = [this](uint64_t data) {
+        // Пустые и старые записи — первые кандидаты на вытеснение
+        return generation_of(data) == generation_ ? depth_of(data) : -1;
+    };
+    Slot* victim = nullptr;
+    int victim_priority = 0;
+    for (int i = 0; i < bucket_size; ++i) {
+        uint64_t data = slots[i].data.load(std::memory_order_relaxed);
+        uint64_t check = slots[i].check.load(std::memory_order_relaxed);
+        if (depth_of(data) != 0 && (check ^ data) == key) {
+            // Оценку той же позиции с меньшей глубиной не сохраняем
+            if (priority(data) > depth) return;
+            victim = &slots[i];
+            break;
+        }
+        if (!victim || priority(data) < victim_priority) {
+            victim = &slots[i];
+            victim_priority = priority(data);
+        }
+    }
+    uint64_t data = pack(score, depth, bound, move, generation_);
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+bool TranspositionTable::is_enabled() const { return buckets_ != nullptr; }
+
+size_t TranspositionTable::get_memory() const {
+    return bucket_count_ * sizeof(Bucket);
+}
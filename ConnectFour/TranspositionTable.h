@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+// Таблица уже оценённых позиций по хешу Zobrist. Записи лежат корзинами
+// по четыре в одной кеш-линии, так что поиск позиции читает одну линию.
+// В корзине вытесняется запись прошлых ходов, а если таких нет — с
+// наименьшей глубиной: глубокие оценки дороже пересчитывать.
+// Потоки поиска пишут и читают таблицу без блокировок: запись — два
+// 64-битных слова, данные и ключ XOR данные. Если запись прочитана
+// наполовину обновлённой, ключ не сойдётся и она будет пропущена
+class TranspositionTable {
+  public:
+    // Оценка точная или только граница: поиск прервался отсечением
+    enum class Bound : uint8_t { Exact, Lower, Upper };
+
+    struct Entry {
+        int score = 0;
+        // Оставшаяся глубина поиска
+        int depth = 0;
+        Bound bound = Bound::Exact;
+        int move = -1;
+    };
+
+    // size_mb == 0 — таблица выключена
+    explicit TranspositionTable(size_t size_mb = 0);
+    void resize(size_t size_mb);
+
+    // Начало поиска очередного хода: записи прошлых ходов вытесняются
+    // первыми. Вызывается, пока другие потоки с таблицей не работают
+    void new_search();
+    std::optional<Entry> probe(uint64_t key) const;
+    void store(uint64_t key, int score, int depth, Bound bound, int move);
+
+    bool is_enabled() const;
+    size_t get_memory() const;
+
+  private:
+    static constexpr int bucket_size = 4;
+    struct Slot {
+        std::atomic<uint64_t> check{0};
+        std::atomic<uint64_t> data{0};
+    };
+    struct alignas(64) Bucket {
+        Slot slots[bucket_size];
+    };
+    static_assert(sizeof(Bucket) == 64);
+
+    // Поля записи в слове data; depth == 0 — пустая запись
+    static uint64_t pack(int score, int depth, Bound bound, int move,
+                         uint8_t generation);
+    static Entry unpack(uint64_t data);
+    static int depth_of(uint64_t data);
+    static uint8_t generation_of(uint64_t data);
+
+    Bucket& bucket_for(uint64_t key) const;
+
+    std::unique_ptr<Bucket[]> buckets_;
+    size_t bucket_count_ = 0;
+    uint8_t generation_ = 0;
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+#include "Position.h"
+
+// Ключи Zobrist: по случайному 64-битному числу на пару (игрок, клетка).
+// Хеш позиции — XOR ключей всех фишек, поэтому ход и его отмена меняют его
+// одним XOR. Ключи вычисляются при компиляции и одинаковы в каждом запуске
+namespace Zobrist {
+
+inline constexpr int max_cells = Position::max_width * Position::max_height;
+
+constexpr uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+inline constexpr auto keys = [] {
+    std::array<uint64_t, 2 * max_cells> result{};
+    uint64_t state = 0x436f6e6e65637434;
+    for (auto& key : result) key = splitmix64(state);
+    return result;
+}();
+
+// p — player1 или player2, cell < max_cells
+constexpr uint64_t key(Participant p, int cell) {
+    return keys[static_cast<int>(p) * max_cells + cell];
+}
+
+}  // namespace Zobrist
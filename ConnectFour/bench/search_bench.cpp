@@ -0,0 +1,115 @@
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "BitboardPosition.h"
+#include "Search.h"
+
+// Число узлов поиска на фиксированной глубине без упорядочивания ходов
+// (колонки слева направо) и с ним, на нескольких позициях поля 7x6, затем
+// время тех же поисков на 1-16 потоках:
+//   ConnectFourSearchBench [DEPTH]
+// Время имеет смысл только для сборки с -DCMAKE_BUILD_TYPE=Release
+
+namespace {
+constexpr int width = 7;
+constexpr int height = 6;
+
+// Партии записаны номерами колонок, ходы по очереди с первого игрока
+constexpr std::string_view openings[] = {
+    "",
+    "3",
+    "33",
+    "3323",
+    "332244",
+    "24344",
+    "33332222",
+};
+
+struct Run {
+    uint64_t nodes;
+    double ms;
+    int column;
+};
+
+Run run_search(std::string_view opening, int depth, bool ordering,
+               int threads = 1) {
+    BitboardPosition position(width, height);
+    Participant p = Participant::player1;
+    for (char c : opening) {
+        position.play(c - '0', p);
+        p = opponent(p);
+    }
+    ComputeParams params{MoveTypes::minimax, depth};
+    params.move_ordering = ordering;
+    params.threads = threads;
+    Search search(p, params);
+    Search::MoveResult result = search.find_move(position);
+    std::chrono::duration<double, std::milli> elapsed = search.get_elapsed();
+    return {search.get_stats().nodes, elapsed.count(), result.column};
+}
+
+// Один поток проходит те же итерации углубления, что и каждый из
+// нескольких, так что отношение времён — эффект только числа потоков.
+// Ускорение имеет смысл, только если ядер не меньше, чем потоков
+void print_thread_scaling(int depth) {
+    std::cout << "\nthreads, hardware concurrency "
+              << std::thread::hardware_concurrency() << "\n"
+              << std::left << std::setw(10) << "threads" << std::right
+              << std::setw(12) << "nodes" << std::setw(10) << "ms"
+              << std::setw(9) << "speedup" << "\n";
+    double single_ms = 0;
+    for (int threads : {1, 2, 4, 8, 16}) {
+        uint64_t nodes = 0;
+        double ms = 0;
+        for (std::string_view opening : openings) {
+            Run run = run_search(opening, depth, true, threads);
+            nodes += run.nodes;
+            ms += run.ms;
+        }
+        if (threads == 1) single_ms = ms;
+        std::cout << std::left << std::setw(10) << threads << std::right
+                  << std::setw(12) << nodes << std::setw(10) << std::fixed
+                  << std::setprecision(1) << ms << std::setw(8)
+                  << std::setprecision(2) << single_ms / ms << "x\n";
+    }
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int depth = 10;
+    if (argc > 1) depth = std::stoi(argv[1]);
+
+    std::cout << "depth " << depth << ", board " << width << "x" << height
+              << "\n"
+              << std::left << std::setw(10) << "opening" << std::right
+              << std::setw(12) << "nodes" << std::setw(10) << "ms"
+              << std::setw(12) << "ordered" << std::setw(10) << "ms"
+              << std::setw(9) << "ratio" << "\n";
+    uint64_t total_plain = 0;
+    uint64_t total_ordered = 0;
+    for (std::string_view opening : openings) {
+        Run plain = run_search(opening, depth, false);
+        Run ordered = run_search(opening, depth, true);
+        total_plain += plain.nodes;
+        total_ordered += ordered.nodes;
+        std::cout << std::left << std::setw(10)
+                  << (opening.empty() ? "-" : std::string(opening))
+                  << std::right << std::setw(12) << plain.nodes
+                  << std::setw(10) << std::fixed << std::setprecision(1)
+                  << plain.ms << std::setw(12) << ordered.nodes
+                  << std::setw(10) << ordered.ms << std::setw(8)
+                  << std::setprecision(2)
+                  << static_cast<double>(plain.nodes) / ordered.nodes
+                  << "x\n";
+    }
+    std::cout << std::left << std::setw(10) << "total" << std::right
+              << std::setw(12) << total_plain << std::setw(10) << ""
+              << std::setw(12) << total_ordered << std::setw(10) << ""
+              << std::setw(8) << std::setprecision(2)
+              << static_cast<double>(total_plain) / total_ordered << "x\n";
+    print_thread_scaling(depth);
+    return 0;
+}
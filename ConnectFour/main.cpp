@@ -1,15 +1,20 @@
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
 #include <string>
 
 #include "Game.h"
+#include "HeadlessTerminal.h"
 
 struct GameParams {
     int width = 7;
     int height = 6;
     std::string player1_spec = "human";
     std::string player2_spec = "human";
+    bool headless = false;
+    RenderStatsOptions stats_options;
+    std::string search_log_path;
 };
 
 // Вспомогательная функция: разделить "key=value" на пару
@@ -69,13 +74,27 @@ GameParams get_params_from_args(int argc, char* argv[]) {
         } else if (key == "-p2") {
             if (value.empty() && i + 1 < argc) value = argv[++i];
             if (!value.empty()) params.player2_spec = value;
+        } else if (key == "-headless") {
+            params.headless = true;
+        } else if (key == "-stats") {
+            if (value.empty() && i + 1 < argc) value = argv[++i];
+            params.stats_options.csv_path = value;
+        } else if (key == "-overlay") {
+            params.stats_options.overlay = true;
+        } else if (key == "-searchlog") {
+            if (value.empty() && i + 1 < argc) value = argv[++i];
+            params.search_log_path = value;
         } else if (key == "-help") {
             std::cout << "Usage: ConnectFour [options]\n"
                       << "Options:\n"
                       << "  -width=N or -width N or -w=N or -w N\n"
                       << "  -height=N or -height N or -h=N or -h N\n"
-                      << "  -p1=TYPE or -p1 TYPE   (e.g. human, minimax:4)\n"
-                      << "  -p2=TYPE or -p2 TYPE\n";
+                      << "  -p1=TYPE or -p1 TYPE   (e.g. human, minimax:4, search:500ms)\n"
+                      << "  -p2=TYPE or -p2 TYPE\n"
+                      << "  -headless              (play without a terminal)\n"
+                      << "  -stats=FILE            (frame stats as CSV on exit)\n"
+                      << "  -overlay               (frame stats line)\n"
+                      << "  -searchlog=FILE        (search stats as CSV)\n";
             exit(0);
         }
     }
@@ -91,6 +110,24 @@ ConnectFour make_game(GameParams params) {
 
 int main(int argc, char* argv[]) {
     GameParams params = get_params_from_args(argc, argv);
+    ConsoleEngine::set_default_stats_options(params.stats_options);
+    std::ofstream search_log;
+    if (!params.search_log_path.empty()) {
+        search_log.open(params.search_log_path, std::ios::trunc);
+        if (search_log)
+            ComputerPlayer::set_search_log(&search_log);
+        else
+            std::cerr << "Cannot write " << params.search_log_path << "\n";
+    }
+    if (params.headless) {
+        // Строка курсора, поле и строка результата
+        HeadlessTerminal terminal(params.width * 2 + 5, params.height + 2);
+        ConsoleEngine::set_default_streams(std::cin, terminal.stream());
+        ConnectFour game = make_game(params);
+        game.play();
+        terminal.write_report(std::cout);
+        return 0;
+    }
     ConnectFour game = make_game(params);
     game.play();
     return 0;
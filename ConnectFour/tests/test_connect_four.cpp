@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string_view>
+#include <vector>
+#include "BitboardPosition.h"
+#include "Position.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+
+namespace {
+// Партия записана номерами колонок, ходы по очереди с первого игрока
+template <typename PositionType>
+PositionType play_moves(int width, int height, std::string_view moves) {
+    PositionType position(width, height);
+    Participant p = Participant::player1;
+    for (char c : moves) {
+        position.play(c - '0', p);
+        p = opponent(p);
+    }
+    return position;
+}
+
+// Поле 8x7 — все 64 бита маски — по колонкам: владельцы фишек снизу вверх
+// ('1' или '2'). Колонка last заполняется последней, её верхняя фишка и
+// проверяется на четвёрку
+struct Layout {
+    Position position{8, 7};
+    BitboardPosition bitboard{8, 7};
+
+    Layout(std::vector<std::string_view> columns, int last) {
+        for (int col = 0; col < static_cast<int>(columns.size()); ++col) {
+            if (col != last) fill(col, columns[col]);
+        }
+        fill(last, columns[last]);
+    }
+
+    void fill(int col, std::string_view owners) {
+        for (char owner : owners) {
+            Participant p =
+                owner == '1' ? Participant::player1 : Participant::player2;
+            position.play(col, p);
+            bitboard.play(col, p);
+        }
+    }
+};
+
+// Случайные партии на обеих позициях: после каждого хода они должны
+// одинаково отвечать на все вопросы поиска, а отмена всех ходов —
+// вернуть пустую позицию с исходным хешем
+void compare_random_games(int width, int height, int games) {
+    std::mt19937 random(width * 100 + height);
+    for (int game = 0; game < games; ++game) {
+        Position position(width, height);
+        BitboardPosition bitboard(width, height);
+        uint64_t empty_hash = bitboard.get_hash();
+        std::vector<int> heights(width, 0);
+        std::vector<int> played;
+        Participant p = Participant::player1;
+        while (!position.is_full()) {
+            std::vector<int> legal;
+            uint64_t expected_moves = 0;
+            for (int col = 0; col < width; ++col) {
+                ASSERT_EQ(position.can_play(col), bitboard.can_play(col));
+                if (!position.can_play(col)) continue;
+                legal.push_back(col);
+                expected_moves |= uint64_t{1}
+                                  << (col * (height + 1) + heights[col]);
+            }
+            ASSERT_EQ(bitboard.legal_moves(), expected_moves);
+            int col = legal[random() % legal.size()];
+            position.play(col, p);
+            bitboard.play(col, p);
+            ++heights[col];
+            played.push_back(col);
+            ASSERT_EQ(position.is_winning(col), bitboard.is_winning(col))
+                << width << "x" << height << " game " << game << " move "
+                << played.size();
+            ASSERT_EQ(position.is_full(), bitboard.is_full());
+            ASSERT_EQ(position.get_free_cells(), bitboard.get_free_cells());
+            if (position.is_winning(col)) break;
+            p = opponent(p);
+        }
+        for (auto it = played.rbegin(); it != played.rend(); ++it) {
+            position.undo(*it);
+            bitboard.undo(*it);
+        }
+        EXPECT_EQ(bitboard.get_hash(), empty_hash);
+        EXPECT_EQ(bitboard.get_free_cells(), width * height);
+        EXPECT_EQ(position.get_free_cells(), width * height);
+    }
+}
+}  // namespace
+
+TEST(BitboardPositionTest, FitsUpTo64BitsWithSentinelRow) {
+    EXPECT_TRUE(BitboardPosition::fits(7, 6));
+    EXPECT_TRUE(BitboardPosition::fits(8, 7));
+    EXPECT_TRUE(BitboardPosition::fits(4, 15));
+    EXPECT_FALSE(BitboardPosition::fits(8, 8));
+    EXPECT_FALSE(BitboardPosition::fits(9, 7));
+    EXPECT_TRUE(Position::fits(16, 16));
+    EXPECT_FALSE(Position::fits(17, 4));
+}
+
+TEST(BitboardPositionTest, MatchesPositionInRandomGames) {
+    compare_random_games(7, 6, 300);
+    compare_random_games(8, 7, 300);
+    compare_random_games(4, 15, 200);
+    compare_random_games(16, 3, 200);
+    compare_random_games(5, 4, 200);
+}
+
+// Верхняя клетка колонки и нижняя следующей соседствуют в маске только
+// через пустую служебную строку
+TEST(BitboardPositionTest, VerticalRunDoesNotWrapIntoNextColumn) {
+    Layout wrap({"2122111", "1"}, 1);
+    EXPECT_FALSE(wrap.position.is_winning(1));
+    EXPECT_FALSE(wrap.bitboard.is_winning(1));
+}
+
+// Последняя колонка 8x7 заканчивается старшим битом слова
+TEST(BitboardPositionTest, TopOfLastColumn) {
+    Layout top({"", "", "", "", "", "", "", "2221111"}, 7);
+    EXPECT_TRUE(top.position.is_winning(7));
+    EXPECT_TRUE(top.bitboard.is_winning(7));
+    EXPECT_FALSE(top.bitboard.can_play(7));
+    // Перенос из заполненной колонки уходит в служебный бит 63
+    EXPECT_EQ(top.bitboard.legal_moves() >> 56, 0u);
+    EXPECT_FALSE(top.bitboard.is_full());
+}
+
+TEST(BitboardPositionTest, DiagonalsAtBottomAndTopRows) {
+    // Вверх-вправо от нижней строки: (0,0), (1,1), (2,2), (3,3)
+    Layout rising({"1", "21", "221", "2221"}, 3);
+    EXPECT_TRUE(rising.position.is_winning(3));
+    EXPECT_TRUE(rising.bitboard.is_winning(3));
+    Layout rising_short({"1", "21", "221", "222"}, 3);
+    EXPECT_FALSE(rising_short.position.is_winning(3));
+    EXPECT_FALSE(rising_short.bitboard.is_winning(3));
+
+    // Вниз-вправо от верхней строки: (4,6), (5,5), (6,4), (7,3)
+    Layout falling({"", "", "", "", "2222221", "222221", "22221", "2221"},
+                   4);
+    EXPECT_TRUE(falling.position.is_winning(4));
+    EXPECT_TRUE(falling.bitboard.is_winning(4));
+    Layout falling_short({"", "", "", "", "2222221", "222221", "22221", "222"},
+                         4);
+    EXPECT_FALSE(falling_short.position.is_winning(4));
+    EXPECT_FALSE(falling_short.bitboard.is_winning(4));
+}
+
+TEST(BitboardPositionTest, SearchAgreesWithPosition) {
+    for (std::string_view opening : {"", "3", "3323", "24344", "0615"}) {
+        auto position = play_moves<Position>(7, 6, opening);
+        auto bitboard = play_moves<BitboardPosition>(7, 6, opening);
+        Participant p = opening.size() % 2 ? Participant::player2
+                                           : Participant::player1;
+        Search position_search(p, ComputeParams{MoveTypes::minimax, 6});
+        Search bitboard_search(p, ComputeParams{MoveTypes::minimax, 6});
+        EXPECT_EQ(position_search.find_move(position).score,
+                  bitboard_search.find_move(bitboard).score)
+            << "opening " << opening;
+    }
+}
+
+TEST(TranspositionTableTest, StoresAndProbesEntries) {
+    TranspositionTable table(1);
+    EXPECT_TRUE(table.is_enabled());
+    EXPECT_EQ(table.get_memory(), 1024u * 1024u);
+    table.new_search();
+    table.store(0x1234, -987, 12, TranspositionTable::Bound::Upper, 5);
+    auto entry = table.probe(0x1234);
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->score, -987);
+    EXPECT_EQ(entry->depth, 12);
+    EXPECT_EQ(entry->bound, TranspositionTable::Bound::Upper);
+    EXPECT_EQ(entry->move, 5);
+    EXPECT_FALSE(table.probe(0x1235).has_value());
+
+    // Оценка той же позиции с меньшей глубиной не затирает глубокую
+    table.store(0x1234, 3, 4, TranspositionTable::Bound::Exact, 1);
+    EXPECT_EQ(table.probe(0x1234)->depth, 12);
+    table.store(0x1234, 3, 14, TranspositionTable::Bound::Exact, -1);
+    EXPECT_EQ(table.probe(0x1234)->score, 3);
+    EXPECT_EQ(table.probe(0x1234)->move, -1);
+
+    TranspositionTable disabled(0);
+    EXPECT_FALSE(disabled.is_enabled());
+    disabled.store(0x1234, 1, 1, TranspositionTable::Bound::Exact, 0);
+    EXPECT_FALSE(disabled.probe(0x1234).has_value());
+}
+
+TEST(TranspositionTableTest, ReplacesShallowestThenOlderEntries) {
+    TranspositionTable table(1);
+    // Корзина — младшие биты ключа: эти ключи попадают в одну корзину
+    const uint64_t buckets = table.get_memory() / 64;
+    auto key = [&](int i) { return 0x77 + i * buckets; };
+    table.new_search();
+    const int depths[4] = {5, 3, 7, 9};
+    for (int i = 0; i < 4; ++i)
+        table.store(key(i), i, depths[i], TranspositionTable::Bound::Exact, i);
+    for (int i = 0; i < 4; ++i) EXPECT_TRUE(table.probe(key(i)).has_value());
+
+    table.store(key(4), 4, 4, TranspositionTable::Bound::Exact, 4);
+    EXPECT_FALSE(table.probe(key(1)).has_value());
+    EXPECT_TRUE(table.probe(key(4)).has_value());
+
+    // Записи прошлого хода вытесняются раньше, даже глубокие
+    table.new_search();
+    table.store(key(5), 5, 1, TranspositionTable::Bound::Exact, 5);
+    EXPECT_TRUE(table.probe(key(5)).has_value());
+    int kept = 0;
+    for (int i : {0, 2, 3, 4}) kept += table.probe(key(i)).has_value();
+    EXPECT_EQ(kept, 3);
+}
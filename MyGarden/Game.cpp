@@ -2,6 +2,8 @@
 
 #include <algorithm>
 
+#include "GameLoop.h"
+
 Cell::Cell(int x, int y, std::unique_ptr<TerrainObject> terrain)
     : pos_x(x),
       pos_y(y),
@@ -10,31 +12,42 @@ Cell::Cell(int x, int y, std::unique_ptr<TerrainObject> terrain)
       is_on_path(false),
       is_on_work(false) {}
 
+// Земля, объект и садовник лежат на своих слоях: меню поверх карты
+// закрывается без перерисовки клеток под ним
 void Cell::draw(ConsoleEngine& engine) {
-    engine.set_cursor_to_pos(pos_x, pos_y);
+    ScreenCell screen_cell;
     if (is_selected) {
         if (is_on_path)
-            engine.set_background_color(Colors256::Gray50);
+            screen_cell.background_color = Colors256::Gray50;
         else if (is_on_work)
-            engine.set_background_color(Color256{160});
+            screen_cell.background_color = Color256{160};
         else
-            engine.set_style(ConsoleStyle::Inverse);
+            screen_cell.style = ConsoleStyle::Inverse;
     } else if (is_on_path)
-        engine.set_background_color(Colors256::Gray80);
+        screen_cell.background_color = Colors256::Gray80;
     else if (is_on_work)
-        engine.set_background_color(Colors256::Red);
-
-    if (gardener)
-        engine.print_color(gardener->get_color(), gardener->get_sprite());
-    else if (entity)
-        engine.print_color(entity->get_color(), entity->get_sprite());
-    else
-        engine.print_color(terrain->get_color(), terrain->get_sprite());
-    engine.reset_styles();
+        screen_cell.background_color = Colors256::Red;
+
+    auto draw_layer = [&](Layer layer, Object* object) {
+        ScreenCell layer_cell = screen_cell;
+        if (object) {
+            layer_cell.glyph = object->get_sprite();
+            layer_cell.text_color = object->get_color();
+        } else {
+            layer_cell = ScreenCell{'\0'};
+        }
+        engine.set_layer(layer);
+        engine.draw_cell(pos_x, pos_y, layer_cell);
+    };
+    draw_layer(Layer::Terrain, terrain.get());
+    draw_layer(Layer::Entity, entity.get());
+    draw_layer(Layer::Actor, gardener.get());
+    engine.set_layer(Layer::Terrain);
 }
 
 Map::Map(int width, int height)
     : width(width), height(height), engine(), player(*this) {
+    engine.resize_frame(width, height);
     engine.clear();
     engine.hide_cursor();
     map.resize(height);
@@ -46,7 +59,8 @@ Map::Map(int width, int height)
     }
     map[player.cursor_pos.y][player.cursor_pos.x].is_selected = true;
     generate();
-    update();
+    tick();
+    render();
 }
 
 Cell& Map::get(int x, int y) { return map[y][x]; }
@@ -289,17 +303,24 @@ void Map::add_gardener() {
     map[y][x].gardener = std::make_unique<Gardener>();
     player.pos = Point(x, y);
 }
-void Map::redraw(int x, int y) { map[y][x].draw(engine); }
-void Map::redraw(Point p) { map[p.y][p.x].draw(engine); }
+// Клетки за краем окна терминала не рисуются: после изменения размера
+// render перерисует то, что стало видно
+void Map::redraw(int x, int y) {
+    if (engine.get_clip().contains(x, y)) map[y][x].draw(engine);
+}
+void Map::redraw(Point p) { redraw(p.x, p.y); }
 void Map::redraw_all() {
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            redraw(x, y);
+    engine.invalidate();
+    const ClipRect& visible = engine.get_clip();
+    drawn_clip = visible;
+    for (int y = visible.y; y < visible.bottom(); ++y) {
+        for (int x = visible.x; x < visible.right(); ++x) {
+            map[y][x].draw(engine);
         }
     }
 }
-void Map::update() {
-    get_player_control();
+void Map::handle_input() { get_player_control(); }
+void Map::tick() {
     player_move();
     for (int y = 0; y < height; ++y) {
         for (int x = 0; x < width; ++x) {
@@ -309,6 +330,10 @@ void Map::update() {
         }
     }
 }
+void Map::render() {
+    if (engine.poll_resize() || engine.get_clip() != drawn_clip) redraw_all();
+    engine.present();
+}
 
 void Map::clear_path() {
     if (!player.active_path.has_value()) return;
@@ -327,26 +352,25 @@ void Map::draw_path() {
 
 void Map::get_player_control() {
     auto old_cursor_pos = player.cursor_pos;
-    auto c = engine.get_no_wait();
-    while (c != '\0') {
-        if (c == 'a') {
+    while (auto key = engine.get_key_no_wait()) {
+        char c = key->get_char();
+        if (c == 'a' || key->code == KeyCode::Left) {
             player.cursor_pos.x = std::max(0, player.cursor_pos.x - 1);
-        } else if (c == 'd') {
+        } else if (c == 'd' || key->code == KeyCode::Right) {
             player.cursor_pos.x = std::min(width - 1, player.cursor_pos.x + 1);
-        } else if (c == 'w') {
+        } else if (c == 'w' || key->code == KeyCode::Up) {
             player.cursor_pos.y = std::max(0, player.cursor_pos.y - 1);
-        } else if (c == 's') {
+        } else if (c == 's' || key->code == KeyCode::Down) {
             player.cursor_pos.y = std::min(height - 1, player.cursor_pos.y + 1);
         } else if (c == 'f') {
             player.create_path();
         } else if (c == 'i') {
             player.see_resouces();
-        } else if (c == 27) {
+        } else if (key->code == KeyCode::Escape) {
             player.clear_action();
-        } else if (c == '\r') {
+        } else if (key->code == KeyCode::Enter) {
             player.new_action();
         }
-        c = engine.get_no_wait();
     }
     if (old_cursor_pos != player.cursor_pos) {
         map[old_cursor_pos.y][old_cursor_pos.x].is_selected = false;
@@ -409,9 +433,20 @@ std::vector<BuildingTypes> Map::get_available_buildings(int x, int y) {
 }
 
 MyGarden::MyGarden(int width, int height) : map(width, height) {}
-void MyGarden::play() {
-    while (true) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        map.update();
-    }
+bool MyGarden::spectate(const std::string& path) {
+    return map.engine.start_spectators(path);
+}
+bool MyGarden::record(const std::string& path) {
+    return map.engine.start_recording(path);
+}
+void MyGarden::play(int max_frames) {
+    GameLoop loop(tick_period);
+    loop.attach_engine(map.engine);
+    loop.on_input([&] {
+        map.handle_input();
+        loop.request_render();
+    });
+    loop.on_tick([&] { map.tick(); });
+    loop.on_render([&] { map.render(); });
+    loop.run(max_frames);
 }
\ No newline at end of file
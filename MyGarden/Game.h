@@ -1,5 +1,6 @@
 #pragma once
 #include <array>
+#include <chrono>
 #include <deque>
 #include <functional>
 #include <memory>
@@ -38,7 +39,9 @@ class Map {
     Map(int width, int height);
     Cell& get(int x, int y);
     Cell& get(Point p);
-    void update();
+    void handle_input();
+    void tick();
+    void render();
     double get_passability(int x, int y);
     double get_passability(Point p);
 
@@ -63,6 +66,9 @@ class Map {
   private:
     std::vector<std::vector<Cell>> map;
     Player player;
+    // Область, которую карта нарисовала целиком. Изменение размера, замеченное
+    // меню, сбрасывает poll_resize, но не её
+    ClipRect drawn_clip;
 
     void generate();
     void generate_lakes();
@@ -77,8 +83,15 @@ class Map {
 
 class MyGarden {
   public:
+    static constexpr std::chrono::milliseconds tick_period{100};
+
     MyGarden(int width = 100, int height = 20);
-    void play();
+    // max_frames < 0 — играть бесконечно
+    void play(int max_frames = -1);
+    // Трансляция игры зрителям через Unix-сокет path
+    bool spectate(const std::string& path);
+    // Журнал сеанса в файл path
+    bool record(const std::string& path);
 
   private:
     Map map;
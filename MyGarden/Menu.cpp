@@ -1,43 +1,72 @@
 #include "Menu.h"
 
-Menu::Menu(ConsoleEngine& engine, int width, int height, int pos_x, int pos_y)
-    : engine(engine),
-      width(width),
-      pos_x(pos_x),
-      pos_y(pos_y),
-      height(height),
-      current_option(0) {}
+Menu::Menu(ConsoleEngine& engine, int width, int height)
+    : engine(engine), width(width), height(height), current_option(0) {
+    place();
+}
+
+// Под меню снова видна карта: present отправит только прямоугольник меню
+Menu::~Menu() {
+    engine.clear_layer(Layer::Overlay, get_rect());
+    engine.present();
+}
+
+// Меню встаёт по центру видимой части карты: в окне меньше карты оно всё
+// равно остаётся на экране
+void Menu::place() {
+    const ClipRect& screen = engine.get_clip();
+    pos_x = screen.x + std::max(0, (screen.width - width) / 2);
+    pos_y = screen.y + std::max(0, (screen.height - height) / 2);
+}
+
+ClipRect Menu::get_rect() const {
+    return ClipRect{pos_x, pos_y, width, height};
+}
+
+// Окно терминала изменило размер: карта под меню собирается из нижних
+// слоёв, а меню перерисовывается на новом месте
+bool Menu::handle_resize() {
+    if (!engine.poll_resize()) return false;
+    engine.clear_layer(Layer::Overlay, get_rect());
+    place();
+    draw();
+    return true;
+}
+
+void Menu::draw_text(int x, int y, std::string_view text, bool is_select) {
+    std::optional<Color256> background;
+    if (is_select) background = Colors256::Gray50;
+    engine.draw_text(pos_x + x, pos_y + y, text, std::nullopt, background);
+}
 
-void Menu::set_relative_pos(int x, int y) {
-    engine.set_cursor_to_pos(pos_x + x, pos_y + y);
+void Menu::clear_row(int y) {
+    engine.draw_fmt<"{:{}}">(pos_x + 1, pos_y + y, "", width - 2);
+}
+
+void Menu::draw_separator(int y) {
+    engine.draw_fmt<"{:-<{}}">(pos_x + 1, pos_y + y, "", width - 2);
 }
 
 void Menu::draw_frame() {
-    for (int x = 0; x < width; ++x) {
-        set_relative_pos(x, 0);
-        engine.print('#');
-    }
-    for (int x = 0; x < width; ++x) {
-        set_relative_pos(x, height - 1);
-        engine.print('#');
-    }
-    for (int y = 0; y < height; ++y) {
-        set_relative_pos(0, y);
-        engine.print('#');
-    }
-    for (int y = 0; y < height; ++y) {
-        set_relative_pos(width - 1, y);
-        engine.print('#');
-    }
+    engine.draw_fmt<"{:#<{}}">(pos_x, pos_y, "", width);
+    engine.draw_fmt<"{:#<{}}">(pos_x, pos_y + height - 1, "", width);
     for (int y = 1; y < height - 1; ++y) {
-        set_relative_pos(1, y);
-        engine.print(std::string(width - 2, ' '));
+        engine.draw_fmt<"#{:{}}#">(pos_x, pos_y + y, "", width - 2);
     }
 }
 
+// Нарисованное на слое меню отправляется в терминал
+void Menu::show() {
+    engine.set_layer(Layer::Terrain);
+    engine.present();
+}
+
 void Menu::draw() {
+    engine.set_layer(Layer::Overlay);
     draw_frame();
+    draw_header();
     draw_options();
+    show();
 }
 
 void Menu::draw_options() {
@@ -49,33 +78,34 @@ void Menu::draw_options() {
 void Menu::select_option(int option) {
     option = std::max(0, std::min(get_options_size() - 1, option));
     if (option == current_option) return;
+    engine.set_layer(Layer::Overlay);
     draw_option(current_option, false);
     current_option = option;
     draw_option(option, true);
+    show();
+}
+
+void Menu::redraw_option(int option) {
+    engine.set_layer(Layer::Overlay);
+    draw_option(option, option == current_option);
+    show();
 }
 
 std::optional<int> MenuSingle::show_options_menu(
-    ConsoleEngine& engine, int width, int heigth, int pos_x, int pos_y,
+    ConsoleEngine& engine, int width, int heigth,
     std::vector<MenuOption> options) {
-    return MenuSingle(engine, width, heigth, pos_x, pos_y, options)
-        .get_option();
+    return MenuSingle(engine, width, heigth, options).get_option();
 }
-MenuSingle::MenuSingle(ConsoleEngine& engine, int width, int height, int pos_x,
-                       int pos_y, std::vector<MenuOption> options)
-    : Menu(engine, width, height, pos_x, pos_y), options(options) {
+MenuSingle::MenuSingle(ConsoleEngine& engine, int width, int height,
+                       std::vector<MenuOption> options)
+    : Menu(engine, width, height), options(options) {
     draw();
 }
 
 void MenuSingle::draw_option(int option, bool is_select) {
-    set_relative_pos((width - 2 - options[option].param.size()) / 2 + 1,
-                     option + 1);
-    if (is_select) {
-        engine.set_background_color(Colors256::Gray50);
-        engine.print(options[option].param);
-        engine.reset_styles();
-    } else {
-        engine.print(options[option].param);
-    }
+    clear_row(option + 1);
+    draw_text((width - 2 - options[option].param.size()) / 2 + 1, option + 1,
+              options[option].param, is_select);
 }
 
 int MenuSingle::get_options_size() { return options.size(); }
@@ -83,6 +113,8 @@ int MenuSingle::get_options_size() { return options.size(); }
 std::optional<int> MenuSingle::get_option() {
     char c;
     do {
+        engine.wait_input();
+        handle_resize();
         c = engine.get_no_wait();
         if (c == 'w') {
             select_option(current_option - 1);
@@ -98,27 +130,22 @@ std::optional<int> MenuSingle::get_option() {
 }
 
 std::optional<std::vector<MenuCountOption>> MenuCount::show_options_menu(
-    ConsoleEngine& engine, int width, int heigth, int pos_x, int pos_y,
+    ConsoleEngine& engine, int width, int heigth,
     std::vector<MenuCountOption> options) {
-    return MenuCount(engine, width, heigth, pos_x, pos_y, options).get_option();
+    return MenuCount(engine, width, heigth, options).get_option();
 }
-MenuCount::MenuCount(ConsoleEngine& engine, int width, int height, int pos_x,
-                     int pos_y, std::vector<MenuCountOption> options)
-    : Menu(engine, width, height, pos_x, pos_y), options(options) {
+MenuCount::MenuCount(ConsoleEngine& engine, int width, int height,
+                     std::vector<MenuCountOption> options)
+    : Menu(engine, width, height), options(options) {
     draw();
 }
 
 void MenuCount::draw_option(int option, bool is_select) {
     std::string option_str =
         options[option].param + " " + std::to_string(options[option].count);
-    set_relative_pos((width - 2 - option_str.size()) / 2 + 1, option + 1);
-    if (is_select) {
-        engine.set_background_color(Colors256::Gray50);
-        engine.print(option_str);
-        engine.reset_styles();
-    } else {
-        engine.print(option_str);
-    }
+    clear_row(option + 1);
+    draw_text((width - 2 - option_str.size()) / 2 + 1, option + 1, option_str,
+              is_select);
 }
 
 int MenuCount::get_options_size() { return options.size(); }
@@ -126,6 +153,8 @@ int MenuCount::get_options_size() { return options.size(); }
 std::optional<std::vector<MenuCountOption>> MenuCount::get_option() {
     char c;
     do {
+        engine.wait_input();
+        handle_resize();
         c = engine.get_no_wait();
         if (c == 'w') {
             select_option(current_option - 1);
@@ -135,11 +164,11 @@ std::optional<std::vector<MenuCountOption>> MenuCount::get_option() {
             options[current_option].count =
                 std::min(options[current_option].count + 1,
                          options[current_option].max_count);
-            draw_option(current_option, true);
+            redraw_option(current_option);
         } else if (c == 'f') {
             options[current_option].count =
                 std::max(options[current_option].count - 1, 0);
-            draw_option(current_option, true);
+            redraw_option(current_option);
         } else if (c == '\r') {
             return options;
         } else if (c == 27) {
@@ -150,15 +179,14 @@ std::optional<std::vector<MenuCountOption>> MenuCount::get_option() {
 }
 
 std::optional<std::vector<MenuMassOption>> MenuMass::show_options_menu(
-    ConsoleEngine& engine, int width, int heigth, int pos_x, int pos_y,
+    ConsoleEngine& engine, int width, int heigth,
     std::vector<MenuMassOption> options, bool is_control) {
-    return MenuMass(engine, width, heigth, pos_x, pos_y, options, is_control).get_option();
+    return MenuMass(engine, width, heigth, options, is_control).get_option();
 }
-MenuMass::MenuMass(ConsoleEngine& engine, int width, int height, int pos_x,
-                   int pos_y, std::vector<MenuMassOption> options, bool is_control)
-    : Menu(engine, width, height, pos_x, pos_y), options(options), is_control(is_control){
+MenuMass::MenuMass(ConsoleEngine& engine, int width, int height,
+                   std::vector<MenuMassOption> options, bool is_control)
+    : Menu(engine, width, height), options(options), is_control(is_control){
     draw();
-    draw_header();
 }
 
 void MenuMass::draw_option(int option, bool is_select) {
@@ -168,28 +196,13 @@ void MenuMass::draw_option(int option, bool is_select) {
         std::to_string(get_resourse_weight(options[option].return_param) *
                        options[option].count);
 
-    set_relative_pos(1, option + 3);
+    clear_row(option + 3);
     int start_offset =
         (width - 3 - second_col_width - option_str.size()) / 2 - 1;
-    engine.print(std::string(start_offset, ' '));
-
-    if (is_select) engine.set_background_color(Colors256::Gray50);
-    engine.print(option_str);
-    if (is_select) engine.reset_styles();
-
-    int second_offset = width - 3 - second_col_width +
-                        (second_col_width - weight_str.size()) / 2 -
-                        (start_offset + option_str.size()) - 1;
-    engine.print(std::string(second_offset, ' '));
-
-    if (is_select) engine.set_background_color(Colors256::Gray50);
-    engine.print(weight_str);
-    if (is_select) engine.reset_styles();
-
-    engine.print(std::string(
-        second_col_width -
-            ((second_col_width - weight_str.size()) / 2 + weight_str.size()),
-        ' '));
+    draw_text(1 + start_offset, option + 3, option_str, is_select);
+    draw_text(width - 3 - second_col_width +
+                  (second_col_width - weight_str.size()) / 2,
+              option + 3, weight_str, is_select);
 }
 
 int MenuMass::get_options_size() { return options.size(); }
@@ -197,6 +210,8 @@ int MenuMass::get_options_size() { return options.size(); }
 std::optional<std::vector<MenuMassOption>> MenuMass::get_option() {
     char c;
     do {
+        engine.wait_input();
+        handle_resize();
         c = engine.get_no_wait();
         if (c == 'w') {
             select_option(current_option - 1);
@@ -206,11 +221,11 @@ std::optional<std::vector<MenuMassOption>> MenuMass::get_option() {
             options[current_option].count =
                 std::min(options[current_option].count + 1,
                          options[current_option].max_count);
-            draw_option(current_option, true);
+            redraw_option(current_option);
         } else if (c == 'f' && is_control) {
             options[current_option].count =
                 std::max(options[current_option].count - 1, 0);
-            draw_option(current_option, true);
+            redraw_option(current_option);
         } else if (c == '\r') {
             return options;
         } else if (c == 27) {
@@ -224,14 +239,10 @@ void MenuMass::draw_header() {
     std::string first_col = "Resource";
     std::string second_col = "Weight";
 
-    set_relative_pos((width - 3 - second_col_width - first_col.size()) / 2 + 1,
-                     1);
-    engine.print(first_col);
-
-    set_relative_pos(width - 3 - second_col_width +
-                         (second_col_width - second_col.size()) / 2,
-                     1);
-    engine.print(second_col);
-    set_relative_pos(1, 2);
-    engine.print(std::string(width - 2, '-'));
+    draw_text((width - 3 - second_col_width - first_col.size()) / 2 + 1, 1,
+              first_col, false);
+    draw_text(width - 3 - second_col_width +
+                  (second_col_width - second_col.size()) / 2,
+              1, second_col, false);
+    draw_separator(2);
 }
\ No newline at end of file
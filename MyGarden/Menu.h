@@ -1,6 +1,7 @@
 #pragma once
 #include <any>
 #include <optional>
+#include <string_view>
 #include <vector>
 
 #include "ConsoleEngine.h"
@@ -31,13 +32,22 @@ class Menu {
     static constexpr int default_height = 10;
 
   protected:
-    Menu(ConsoleEngine& engine, int width, int height, int pos_x, int pos_y);
+    // Меню рисуется на слое Overlay; при закрытии слой под ним очищается,
+    // и перерисовываются только клетки меню
+    Menu(ConsoleEngine& engine, int width, int height);
+    virtual ~Menu();
 
     virtual void draw_option(int option, bool is_select) = 0;
     virtual int get_options_size() = 0;
-    void set_relative_pos(int x, int y);
+    virtual void draw_header() {}
+    // Координаты от левого верхнего угла рамки
+    void draw_text(int x, int y, std::string_view text, bool is_select);
+    void clear_row(int y);
+    void draw_separator(int y);
     void select_option(int option);
+    void redraw_option(int option);
     void draw();
+    bool handle_resize();
 
     ConsoleEngine& engine;
     int width;
@@ -45,8 +55,11 @@ class Menu {
     int current_option;
 
   private:
+    void place();
+    ClipRect get_rect() const;
     void draw_frame();
     void draw_options();
+    void show();
 
     int pos_x;
     int pos_y;
@@ -55,12 +68,12 @@ class Menu {
 class MenuSingle : public Menu {
   public:
     static std::optional<int> show_options_menu(
-        ConsoleEngine& engine, int width, int heigth, int pos_x, int pos_y,
+        ConsoleEngine& engine, int width, int heigth,
         std::vector<MenuOption> options);
 
   private:
-    MenuSingle(ConsoleEngine& engine, int width, int height, int pos_x,
-               int pos_y, std::vector<MenuOption> options);
+    MenuSingle(ConsoleEngine& engine, int width, int height,
+               std::vector<MenuOption> options);
     void draw_option(int option, bool is_select) override;
     int get_options_size() override;
     std::optional<int> get_option();
@@ -71,12 +84,12 @@ class MenuSingle : public Menu {
 class MenuCount : public Menu {
   public:
     static std::optional<std::vector<MenuCountOption>> show_options_menu(
-        ConsoleEngine& engine, int width, int heigth, int pos_x, int pos_y,
+        ConsoleEngine& engine, int width, int heigth,
         std::vector<MenuCountOption> options);
 
   private:
-    MenuCount(ConsoleEngine& engine, int width, int height, int pos_x,
-              int pos_y, std::vector<MenuCountOption> options);
+    MenuCount(ConsoleEngine& engine, int width, int height,
+              std::vector<MenuCountOption> options);
     void draw_option(int option, bool is_select) override;
     int get_options_size() override;
     std::optional<std::vector<MenuCountOption>> get_option();
@@ -87,16 +100,16 @@ class MenuCount : public Menu {
 class MenuMass : public Menu {
   public:
     static std::optional<std::vector<MenuMassOption>> show_options_menu(
-        ConsoleEngine& engine, int width, int heigth, int pos_x, int pos_y,
+        ConsoleEngine& engine, int width, int heigth,
         std::vector<MenuMassOption> options, bool is_control = true);
 
   private:
-    MenuMass(ConsoleEngine& engine, int width, int height, int pos_x, int pos_y,
+    MenuMass(ConsoleEngine& engine, int width, int height,
              std::vector<MenuMassOption> options, bool is_control);
     void draw_option(int option, bool is_select) override;
     int get_options_size() override;
     std::optional<std::vector<MenuMassOption>> get_option();
-    void draw_header();
+    void draw_header() override;
 
     std::vector<MenuMassOption> options;
     const int second_col_width = 6;
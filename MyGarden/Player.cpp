@@ -211,10 +211,7 @@ void Player::new_action() {
     }
 
     auto chose = MenuSingle::show_options_menu(
-        map.engine, Menu::default_width, Menu::default_height,
-        (map.width - Menu::default_width) / 2,
-        (map.height - Menu::default_height) / 2, menu_options);
-    map.redraw_all();
+        map.engine, Menu::default_width, Menu::default_height, menu_options);
 
     if (!chose.has_value()) return;
     PlayerActionTypes chosed = std::any_cast<PlayerActionTypes>(
@@ -277,9 +274,7 @@ void Player::new_start_build_action() {
 
     auto chose_object_ind = MenuSingle::show_options_menu(
         map.engine, Menu::default_width, Menu::default_height,
-        (map.width - Menu::default_width) / 2,
-        (map.height - Menu::default_height) / 2, menu_buildings_options);
-    map.redraw_all();
+        menu_buildings_options);
     if (!chose_object_ind.has_value()) return;
     BuildingTypes chose_object = std::any_cast<BuildingTypes>(
         menu_buildings_options[chose_object_ind.value()].return_param);
@@ -302,10 +297,7 @@ void Player::new_continue_build_action() {
     }
 
     auto chosed_options = MenuMass::show_options_menu(
-        map.engine, Menu::default_width, Menu::default_height,
-        (map.width - Menu::default_width) / 2,
-        (map.height - Menu::default_height) / 2, menu_options);
-    map.redraw_all();
+        map.engine, Menu::default_width, Menu::default_height, menu_options);
 
     if (!chosed_options.has_value()) return;
     ResourceMap chosed_resources;
@@ -331,9 +323,7 @@ void Player::new_place_action() {
     }
     auto chose_object = MenuSingle::show_options_menu(
         map.engine, Menu::default_width, Menu::default_height,
-        (map.width - Menu::default_width) / 2,
-        (map.height - Menu::default_height) / 2, place_menu_options);
-    map.redraw_all();
+        place_menu_options);
     if (!chose_object.has_value()) return;
     create_path_to_area();
     if (place_menu_options[chose_object.value()].param == "Flower")
@@ -351,10 +341,7 @@ void Player::new_dump_resources_action(Point action_pos) {
     }
 
     auto chosed_options = MenuMass::show_options_menu(
-        map.engine, Menu::default_width, Menu::default_height,
-        (map.width - Menu::default_width) / 2,
-        (map.height - Menu::default_height) / 2, menu_options);
-    map.redraw_all();
+        map.engine, Menu::default_width, Menu::default_height, menu_options);
 
     if (!chosed_options.has_value()) return;
     ResourceMap chosed_resources;
@@ -378,10 +365,7 @@ void Player::new_drop_resources_action() {
     }
 
     auto chosed_options = MenuMass::show_options_menu(
-        map.engine, Menu::default_width, Menu::default_height,
-        (map.width - Menu::default_width) / 2,
-        (map.height - Menu::default_height) / 2, menu_options);
-    map.redraw_all();
+        map.engine, Menu::default_width, Menu::default_height, menu_options);
 
     if (!chosed_options.has_value()) return;
     ResourceMap chosed_resources;
@@ -407,10 +391,7 @@ void Player::new_get_resources_from_dump_action() {
     }
 
     auto chosed_options = MenuMass::show_options_menu(
-        map.engine, Menu::default_width, Menu::default_height,
-        (map.width - Menu::default_width) / 2,
-        (map.height - Menu::default_height) / 2, menu_options);
-    map.redraw_all();
+        map.engine, Menu::default_width, Menu::default_height, menu_options);
 
     if (!chosed_options.has_value()) return;
     ResourceMap chosed_resources;
@@ -434,11 +415,8 @@ void Player::see_resouces() {
                                   count);
     }
 
-    MenuMass::show_options_menu(
-        map.engine, Menu::default_width, Menu::default_height,
-        (map.width - Menu::default_width) / 2,
-        (map.height - Menu::default_height) / 2, menu_options, false);
-    map.redraw_all();
+    MenuMass::show_options_menu(map.engine, Menu::default_width,
+                                Menu::default_height, menu_options, false);
 }
 
 bool Player::check_resources(PlayerActionTypes action) {
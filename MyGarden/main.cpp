@@ -1,12 +1,30 @@
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
 
 #include "Game.h"
+#include "GameOptions.h"
+#include "HeadlessTerminal.h"
 
 int main(int argc, char* argv[]) {
+    std::optional<GameOptions> options =
+        GameOptions::parse(argc, argv, std::cerr);
+    if (!options) return 1;
+    ConsoleEngine::set_default_stats_options(options->stats);
+    if (options->headless_frames) {
+        // Лишняя строка — для строки статистики
+        HeadlessTerminal terminal(100, 21);
+        ConsoleEngine::set_default_streams(std::cin, terminal.stream());
+        MyGarden game = MyGarden(100, 20);
+        options->start_outputs(game, std::cerr);
+        game.play(*options->headless_frames);
+        terminal.write_report(std::cout);
+        return 0;
+    }
     MyGarden game = MyGarden();
+    options->start_outputs(game, std::cerr);
     game.play();
     return 0;
 }
\ No newline at end of file
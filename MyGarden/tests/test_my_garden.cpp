@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ConsoleEngine.h"
+#include "Game.h"
+#include "HeadlessTerminal.h"
+#include "Menu.h"
+
+namespace {
+std::vector<std::string> screen_rows(const HeadlessTerminal& terminal,
+                                     int height) {
+    std::vector<std::string> rows;
+    for (int y = 0; y < height; ++y) rows.push_back(terminal.row_text(y));
+    return rows;
+}
+}  // namespace
+
+// Изменение размера замечает меню и сбрасывает poll_resize; карта всё равно
+// должна дорисовать то, что стало видно, когда меню закроется
+TEST(MenuTest, MapRepaintsCellsShownWhileMenuWasOpen) {
+    constexpr int width = 40;
+    constexpr int height = 10;
+    std::istringstream in("\x1b");
+    HeadlessTerminal terminal(width, height);
+    ConsoleEngine::set_default_streams(in, terminal.stream());
+    {
+        Map map(width, height);
+        map.engine.set_terminal_size(TerminalSize{20, 5});
+        map.render();
+        // Клетка за краем маленького окна: её отрисовка отбрасывается.
+        // Садовник занимает одну клетку, поэтому одна из двух свободна
+        const int rock_x = map.get(30, 7).gardener ? 31 : 30;
+        ASSERT_FALSE(map.get(rock_x, 7).gardener);
+        map.set_new_terrain(rock_x, 7, std::make_unique<Rock>());
+        map.reset_entity(rock_x, 7);
+
+        map.engine.set_terminal_size(TerminalSize{width, height});
+        auto chosen = MenuSingle::show_options_menu(map.engine, 10, 4,
+                                                    {{"ok", 0}});
+        EXPECT_FALSE(chosen.has_value());
+        map.render();
+        std::vector<std::string> after_menu = screen_rows(terminal, height);
+        EXPECT_EQ(terminal.at(rock_x, 7).glyph, Rock().get_sprite());
+
+        map.redraw_all();
+        map.render();
+        EXPECT_EQ(after_menu, screen_rows(terminal, height));
+    }
+    ConsoleEngine::reset_default_streams();
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+
+enum class ConsoleStyle {
+    Reset = 0,
+    Bold = 1,
+    Underline = 4,
+    Inverse = 7,
+};
+enum class ConsoleTextColors {
+    Black = 30,
+    Red = 31,
+    Green = 32,
+    Yellow = 33,
+    Blue = 34,
+    Magenta = 35,
+    Cyan = 36,
+    White = 37,
+};
+enum class ConsoleBkgColors {
+    Black = 40,
+    Red = 41,
+    Green = 42,
+    Yellow = 43,
+    Blue = 44,
+    Magenta = 45,
+    Cyan = 46,
+    White = 47,
+};
+
+struct Color256 {
+    uint8_t id;
+    constexpr Color256(int i) : id(static_cast<uint8_t>(i)) {};
+    constexpr bool operator==(const Color256& other) const = default;
+};
+
+namespace Colors256{
+    constexpr Color256 Black{0};
+    constexpr Color256 Red{196};
+    constexpr Color256 Green{46};
+    constexpr Color256 Yellow{226};
+    constexpr Color256 Blue{21};
+    constexpr Color256 Magenta{201};
+    constexpr Color256 Cyan{51};
+    constexpr Color256 White{231};
+    constexpr Color256 Pink{198};
+    constexpr Color256 Orange{208};
+    constexpr Color256 Gray20{235};
+    constexpr Color256 Gray50{240};
+    constexpr Color256 Gray80{248};
+    constexpr Color256 DarkGreen{22};
+    constexpr Color256 GrayBrown{101};
+    constexpr Color256 LightBrown{136};
+    constexpr Color256 OrangeBrown{130};
+    constexpr Color256 Purple{92};
+}
@@ -1,67 +1,725 @@
 #include "ConsoleEngine.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
 #include <iostream>
 
-ConsoleEngine::ConsoleEngine() : ConsoleEngine(std::cin, std::cout) {}
+#include "EscapeFormat.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace {
+std::istream* default_in = &std::cin;
+std::ostream* default_out = &std::cout;
+RenderStatsOptions default_stats_options;
+}  // namespace
+
+ConsoleEngine::ConsoleEngine() : ConsoleEngine(*default_in, *default_out) {
+    stats_.set_options(default_stats_options);
+}
 ConsoleEngine::ConsoleEngine(std::istream& in, std::ostream& out)
     : cin_(in), cout_(out) {
     enableAnsiColors();
+    if (has_terminal()) {
+        TerminalSizeWatch::watch();
+        resize_generation_ = TerminalSizeWatch::get_generation();
+        terminal_size_ = TerminalSizeWatch::query();
+#ifndef _WIN32
+        backlog_ = OutputBacklog::for_fd(STDOUT_FILENO);
+#endif
+        // Медленный терминал не должен задерживать шаги игры
+        set_render_thread(true);
+    }
 }
 ConsoleEngine::~ConsoleEngine() {
+    render_thread_.stop();
+    if (frame_depth_ > 0) {
+        frame_depth_ = 1;
+        end_frame();
+    }
     reset_styles();
     show_cursor();
-    cout_ << "\033[999B\n";
+    append("\033[999B\n");
+    commit(false);
     flush_input_buffer();
 }
 
-void ConsoleEngine::clear() { cout_ << "\033[2J\033[H" << std::flush; }
+void ConsoleEngine::set_default_streams(std::istream& in, std::ostream& out) {
+    default_in = &in;
+    default_out = &out;
+}
+void ConsoleEngine::reset_default_streams() {
+    default_in = &std::cin;
+    default_out = &std::cout;
+}
+void ConsoleEngine::set_default_stats_options(RenderStatsOptions options) {
+    default_stats_options = std::move(options);
+}
+bool ConsoleEngine::has_terminal() const { return &cout_ == &std::cout; }
+
+void ConsoleEngine::clear() {
+    wait_renderer();
+    sync_styles();
+    append("\033[2J\033[H");
+    commit(true);
+    front_buffer_.fill(ScreenCell{});
+}
 
-void ConsoleEngine::set_cursor_to_zero() { cout_ << "\033[H"; }
+void ConsoleEngine::set_cursor_to_zero() {
+    wait_renderer();
+    append("\033[H");
+    commit(false);
+}
 
 void ConsoleEngine::set_cursor_to_pos(int x, int y) {
-    cout_ << "\033[" << (y + 1) << ";" << (x + 1) << "H" << std::flush;
+    wait_renderer();
+    EscapeFormat::append_cursor_position(output_, x, y);
+    commit(true);
 }
 
-void ConsoleEngine::hide_cursor() { cout_ << "\033[?25l" << std::flush; }
-void ConsoleEngine::show_cursor() { cout_ << "\033[?25h" << std::flush; }
+void ConsoleEngine::hide_cursor() {
+    wait_renderer();
+    append("\033[?25l");
+    commit(true);
+}
+void ConsoleEngine::show_cursor() {
+    wait_renderer();
+    append("\033[?25h");
+    commit(true);
+}
 
 std::string ConsoleEngine::get() {
     std::string input;
     std::getline(cin_, input);
-    cout_ << "\033[1A\033[2K\033[G" << std::flush;
+    recorder_.record_line(input);
+    wait_renderer();
+    append("\033[1A\033[2K\033[G");
+    commit(true);
     return input;
 }
 
-char ConsoleEngine::get_no_wait() {
-    if (::uni_kbhit()) {
-        return ::uni_getch();
-    }
-    return '\0';
-}
 
-void ConsoleEngine::reset_styles() {
-    cout_ << "\033[" << static_cast<int>(ConsoleStyle::Reset) << "m";
-}
+void ConsoleEngine::reset_styles() { set_style(ConsoleStyle::Reset); }
 void ConsoleEngine::set_style(ConsoleStyle style) {
-    cout_ << "\033[" << static_cast<int>(style) << "m";
+    wait_renderer();
+    if (style == ConsoleStyle::Reset)
+        reset_pending_sgr();
+    else
+        pending_sgr_.styles |= 1 << static_cast<int>(style);
+    commit(false);
 }
 void ConsoleEngine::set_color(ConsoleTextColors text_color) {
-    cout_ << "\033[" << static_cast<int>(text_color) << "m";
+    wait_renderer();
+    pending_sgr_.text_color = static_cast<int>(text_color);
+    commit(false);
 }
 void ConsoleEngine::set_color(ConsoleBkgColors background_color) {
-    cout_ << "\033[" << static_cast<int>(background_color) << "m";
+    wait_renderer();
+    pending_sgr_.background_color = static_cast<int>(background_color);
+    commit(false);
 }
 void ConsoleEngine::set_color(ConsoleTextColors text_color,
                               ConsoleBkgColors background_color) {
-    cout_ << "\033[" << static_cast<int>(text_color) << ";"
-          << static_cast<int>(background_color) << "m";
+    wait_renderer();
+    pending_sgr_.text_color = static_cast<int>(text_color);
+    pending_sgr_.background_color = static_cast<int>(background_color);
+    commit(false);
 }
 void ConsoleEngine::set_text_color(Color256 color) {
-    cout_ << "\033[38;5;" << static_cast<int>(color.id) << "m";
+    wait_renderer();
+    pending_sgr_.text_color = 256 + color.id;
+    commit(false);
 }
 void ConsoleEngine::set_background_color(Color256 color) {
-    cout_ << "\033[48;5;" << static_cast<int>(color.id) << "m";
+    wait_renderer();
+    pending_sgr_.background_color = 256 + color.id;
+    commit(false);
 }
+
+void ConsoleEngine::reset_pending_sgr() {
+    pending_sgr_ = SgrState{};
+    // Состояние терминала до первого сброса неизвестно — сброс обязателен
+    if (!sgr_known_) current_sgr_.styles = 0xFF;
+}
+
+void ConsoleEngine::sync_styles() {
+    sgr_known_ = true;
+    if (pending_sgr_ == current_sgr_) return;
+    const SgrState& from = current_sgr_;
+    bool first = true;
+    if (pending_sgr_ == SgrState{}) {
+        append_sgr_param(static_cast<int>(ConsoleStyle::Reset), first);
+    } else {
+        bool lost = (from.styles & ~pending_sgr_.styles) ||
+                    (from.text_color && !pending_sgr_.text_color) ||
+                    (from.background_color && !pending_sgr_.background_color);
+        const SgrState base = lost ? SgrState{} : from;
+        if (lost) append_sgr_param(static_cast<int>(ConsoleStyle::Reset), first);
+        for (int code = 1; code < 8; ++code) {
+            if ((pending_sgr_.styles & ~base.styles) & (1 << code))
+                append_sgr_param(code, first);
+        }
+        if (pending_sgr_.text_color != base.text_color)
+            append_sgr_color(pending_sgr_.text_color, 38, first);
+        if (pending_sgr_.background_color != base.background_color)
+            append_sgr_color(pending_sgr_.background_color, 48, first);
+    }
+    if (!first) append('m');
+    current_sgr_ = pending_sgr_;
+}
+
+void ConsoleEngine::append_sgr_param(int value, bool& first) {
+    append(first ? "\033[" : ";");
+    EscapeFormat::append_uint(output_, static_cast<uint32_t>(value));
+    first = false;
+}
+
+void ConsoleEngine::append_sgr_color(int color, int extended_code,
+                                     bool& first) {
+    if (color < 256) {
+        append_sgr_param(color, first);
+        return;
+    }
+    append(first ? "\033[" : ";");
+    first = false;
+    const auto& table = extended_code == 38
+                            ? EscapeFormat::text_color_params
+                            : EscapeFormat::background_color_params;
+    append(table[color - 256].view());
+}
+
+void ConsoleEngine::begin_frame() {
+    wait_renderer();
+    if (frame_depth_++ == 0) stats_.begin_frame();
+}
+
+void ConsoleEngine::end_frame() {
+    wait_renderer();
+    if (frame_depth_ == 0 || --frame_depth_ > 0) return;
+    flush_frame(back_buffer_, terminal_size_);
+}
+
+void ConsoleEngine::flush_frame(const FrameBuffer& frame,
+                                const std::optional<TerminalSize>& screen) {
+    sync_styles();
+    append_stats_overlay(frame, screen);
+    write_to_terminal();
+    stats_.end_frame();
+}
+
+uint64_t ConsoleEngine::get_avoided_flushes() const {
+    wait_renderer();
+    return avoided_flushes_;
+}
+
+void ConsoleEngine::set_render_thread(bool enabled) {
+    if (!enabled) {
+        render_thread_.stop();
+        return;
+    }
+    // Поток вызывает только внутренние функции, которые не ждут его самого
+    render_thread_.start(
+        [this](const FrameSnapshot& snapshot) {
+            stats_.begin_frame();
+            append_frame(snapshot.cells, snapshot.params);
+            flush_frame(snapshot.cells, snapshot.params.terminal_size);
+        },
+        [this] { return output_delay(); });
+}
+
+uint64_t ConsoleEngine::get_dropped_frames() const {
+    return render_thread_.get_dropped_frames() + skipped_frames_;
+}
+
+void ConsoleEngine::set_latency_budget(std::chrono::nanoseconds budget) {
+    wait_renderer();
+    latency_budget_ = budget;
+}
+
+void ConsoleEngine::set_output_backlog(OutputBacklog backlog) {
+    wait_renderer();
+    backlog_ = std::move(backlog);
+}
+
+bool ConsoleEngine::start_spectators(const std::string& path) {
+    wait_renderer();
+    return spectators_.listen(path);
+}
+
+void ConsoleEngine::stop_spectators() {
+    wait_renderer();
+    spectators_.close();
+}
+
+size_t ConsoleEngine::get_spectator_count() const {
+    return spectators_.get_subscriber_count();
+}
+
+bool ConsoleEngine::start_recording(const std::string& path) {
+    wait_renderer();
+    if (!recorder_.open(path)) return false;
+    // Проигрывателю нужен размер экрана с самого начала
+    if (terminal_size_) {
+        recorder_.record_resize(*terminal_size_);
+    } else if (back_buffer_.get_width() > 0) {
+        recorder_.record_resize(
+            TerminalSize{back_buffer_.get_width(), back_buffer_.get_height()});
+    }
+    // Журнал начинается с полного кадра, иначе проигрыватель не увидит того,
+    // что было на экране до начала записи
+    invalidate();
+    return true;
+}
+
+void ConsoleEngine::stop_recording() {
+    wait_renderer();
+    recorder_.close();
+}
+
+// Вывод уходит в журнал и зрителям. Для зрителей он кодируется один раз,
+// все получают общий буфер. Полный кадр строится, только если его кто-то
+// ждёт; новый зритель получает его и на кадре без изменений, иначе на
+// неподвижном экране он ничего бы не увидел
+void ConsoleEngine::publish_output(bool flushed) {
+    recorder_.record_output(output_, flushed);
+    if (!spectators_.is_listening()) return;
+    if (output_.empty() && !spectators_.needs_keyframe()) return;
+    auto diff = std::make_shared<const std::string>(output_);
+    SpectatorServer::Frame keyframe;
+    if (spectators_.needs_keyframe()) {
+        keyframe = std::make_shared<const std::string>(
+            SpectatorServer::encode_screen(front_buffer_));
+    }
+    spectators_.publish(std::move(diff), std::move(keyframe));
+}
+
+// Сколько ждать, пока отставание терминала не войдёт в допустимое
+std::chrono::nanoseconds ConsoleEngine::output_delay() const {
+    auto delay = backlog_.estimate_delay() - latency_budget_;
+    return std::max(delay, std::chrono::nanoseconds::zero());
+}
+
+void ConsoleEngine::wait_renderer() const { render_thread_.wait_idle(); }
+
+void ConsoleEngine::set_stats_options(RenderStatsOptions options) {
+    wait_renderer();
+    stats_.set_options(std::move(options));
+}
+const FrameStats& ConsoleEngine::get_last_frame_stats() const {
+    wait_renderer();
+    return stats_.get_last();
+}
+const std::vector<FrameStats>& ConsoleEngine::get_frame_stats() const {
+    wait_renderer();
+    return stats_.get_history();
+}
+
+void ConsoleEngine::append_stats_overlay(
+    const FrameBuffer& frame, const std::optional<TerminalSize>& screen) {
+    int row = frame.get_height();
+    if (!stats_.get_options().overlay || row == 0) return;
+    if (screen && row >= screen->height) return;
+    // Курсор и атрибуты сохраняются (DECSC/DECRC), строка не влияет на кадр
+    append("\0337");
+    EscapeFormat::append_cursor_position(output_, 0, row);
+    append("\033[0m\033[2K");
+    // Строка обрезается по ширине кадра, чтобы не было переноса
+    std::string text = stats_.format_overlay();
+    text.resize(std::min<size_t>(text.size(), frame.get_width()));
+    append(text);
+    append("\0338");
+}
+
+void ConsoleEngine::commit(bool flush) {
+    if (frame_depth_ > 0) {
+        if (flush) ++avoided_flushes_;
+        return;
+    }
+    sync_styles();
+    if (output_.empty() && !flush) return;
+    auto started = RenderStats::Clock::now();
+    cout_.write(output_.data(), output_.size());
+    if (flush) cout_.flush();
+    stats_.record_write(output_, flush, started, RenderStats::Clock::now());
+    publish_output(flush);
+    output_.clear();
+}
+
+#ifdef _WIN32
+void ConsoleEngine::write_to_terminal() {
+    auto started = RenderStats::Clock::now();
+    backlog_.before_write(started);
+    cout_.write(output_.data(), output_.size());
+    cout_.flush();
+    auto finished = RenderStats::Clock::now();
+    backlog_.after_write(output_.size(), started, finished);
+    stats_.record_write(output_, true, started, finished);
+    publish_output(true);
+    output_.clear();
+}
+#else
+void ConsoleEngine::write_to_terminal() {
+    auto started = RenderStats::Clock::now();
+    backlog_.before_write(started);
+    if (&cout_ != &std::cout) {
+        cout_.write(output_.data(), output_.size());
+        cout_.flush();
+        auto finished = RenderStats::Clock::now();
+        backlog_.after_write(output_.size(), started, finished);
+        stats_.record_write(output_, true, started, finished);
+        publish_output(true);
+        output_.clear();
+        return;
+    }
+    // Весь кадр уходит в терминал одним write(2), минуя буфер stdio
+    cout_.flush();
+    const char* data = output_.data();
+    size_t left = output_.size();
+    while (left > 0) {
+        ssize_t written = ::write(STDOUT_FILENO, data, left);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        data += written;
+        left -= written;
+    }
+    auto finished = RenderStats::Clock::now();
+    backlog_.after_write(output_.size(), started, finished);
+    stats_.record_write(output_, true, started, finished);
+    publish_output(true);
+    output_.clear();
+}
+#endif
+
+void ConsoleEngine::resize_frame(int width, int height) {
+    wait_renderer();
+    back_buffer_.resize(width, height);
+    front_buffer_.resize(width, height);
+    if (layered_) {
+        for (size_t layer = 0; layer < layer_count; ++layer) {
+            layers_[layer].resize(width, height);
+            if (layer > 0) layers_[layer].fill(ScreenCell{'\0'});
+        }
+    }
+    update_clip();
+    invalidate();
+}
+
+std::optional<TerminalSize> ConsoleEngine::get_terminal_size() const {
+    return terminal_size_;
+}
+
+void ConsoleEngine::set_terminal_size(TerminalSize size) {
+    requested_size_ = size;
+}
+
+bool ConsoleEngine::poll_resize() {
+    refresh_viewport();
+    bool resized = resize_unreported_;
+    resize_unreported_ = false;
+    return resized;
+}
+
+void ConsoleEngine::set_clip(const ClipRect& clip) {
+    user_clip_ = clip;
+    update_clip();
+}
+
+void ConsoleEngine::reset_clip() {
+    user_clip_.reset();
+    update_clip();
+}
+
+const ClipRect& ConsoleEngine::get_clip() const { return clip_; }
+
+void ConsoleEngine::refresh_viewport() {
+    std::optional<TerminalSize> size;
+    if (requested_size_) {
+        size = requested_size_;
+        requested_size_.reset();
+    } else if (has_terminal()) {
+#ifndef _WIN32
+        // Пока не было SIGWINCH, размер не менялся и ioctl не нужен
+        uint32_t generation = TerminalSizeWatch::get_generation();
+        if (generation == resize_generation_) return;
+        resize_generation_ = generation;
+#endif
+        size = TerminalSizeWatch::query();
+    } else {
+        return;
+    }
+    if (size == terminal_size_) return;
+    terminal_size_ = size;
+    if (size) recorder_.record_resize(*size);
+    update_clip();
+    // Терминал мог переложить строки по-своему: всё видимое отправляется
+    // заново поверх старого, без очистки экрана
+    invalidate();
+    erase_margins_ = true;
+    resize_unreported_ = true;
+}
+
+void ConsoleEngine::update_clip() {
+    clip_ = ClipRect{0, 0, back_buffer_.get_width(), back_buffer_.get_height()};
+    if (terminal_size_)
+        clip_ = clip_.intersect(
+            ClipRect{0, 0, terminal_size_->width, terminal_size_->height});
+    if (user_clip_) clip_ = clip_.intersect(*user_clip_);
+}
+
+// Справа и снизу от кадра после изменения размера могут остаться обрывки
+// старых строк: они стираются EL и ED, а не очисткой всего экрана
+void ConsoleEngine::append_margin_erase(const FrameBuffer& frame,
+                                        const TerminalSize& screen) {
+    int width = frame.get_width();
+    int height = frame.get_height();
+    sync_styles();
+    if (screen.width > width) {
+        for (int y = 0; y < std::min(height, screen.height); ++y) {
+            EscapeFormat::append_cursor_position(output_, width, y);
+            append("\033[K");
+        }
+    }
+    if (screen.height > height) {
+        EscapeFormat::append_cursor_position(output_, 0, height);
+        append("\033[J");
+    }
+}
+
+void ConsoleEngine::set_layer(Layer layer) { layer_ = layer; }
+Layer ConsoleEngine::get_layer() const { return layer_; }
+
+void ConsoleEngine::enable_layers() {
+    layers_[0] = back_buffer_;
+    for (size_t layer = 1; layer < layer_count; ++layer) {
+        layers_[layer].resize(back_buffer_.get_width(),
+                              back_buffer_.get_height());
+        layers_[layer].fill(ScreenCell{'\0'});
+    }
+    layered_ = true;
+}
+
+void ConsoleEngine::compose_cell(int x, int y) {
+    for (size_t layer = layer_count - 1; layer > 0; --layer) {
+        const ScreenCell& cell = layers_[layer].at(x, y);
+        if (cell.glyph != '\0') {
+            back_buffer_.at(x, y) = cell;
+            return;
+        }
+    }
+    back_buffer_.at(x, y) = layers_[0].at(x, y);
+}
+
+void ConsoleEngine::clear_layer(Layer layer, const ClipRect& rect) {
+    if (!layered_ && layer != Layer::Terrain) return;
+    ScreenCell empty =
+        layer == Layer::Terrain ? ScreenCell{} : ScreenCell{'\0'};
+    ClipRect area = rect.intersect(
+        ClipRect{0, 0, back_buffer_.get_width(), back_buffer_.get_height()});
+    for (int y = area.y; y < area.bottom(); ++y) {
+        for (int x = area.x; x < area.right(); ++x) {
+            if (!layered_) {
+                back_buffer_.at(x, y) = empty;
+                continue;
+            }
+            layers_[static_cast<size_t>(layer)].at(x, y) = empty;
+            compose_cell(x, y);
+        }
+    }
+}
+
+void ConsoleEngine::draw_cell(int x, int y, const ScreenCell& cell) {
+    if (!clip_.contains(x, y)) return;
+    if (!layered_) {
+        if (layer_ == Layer::Terrain) {
+            back_buffer_.at(x, y) = cell;
+            return;
+        }
+        enable_layers();
+    }
+    layers_[static_cast<size_t>(layer_)].at(x, y) = cell;
+    compose_cell(x, y);
+}
+
+void ConsoleEngine::draw_text(int x, int y, std::string_view text,
+                              std::optional<Color256> text_color,
+                              std::optional<Color256> background_color) {
+    for (char c : text) {
+        draw_cell(x++, y, ScreenCell{c, text_color, background_color});
+    }
+}
+
+void ConsoleEngine::invalidate() {
+    wait_renderer();
+    // '\0' не встречается в back-буфере, все клетки будут перерисованы
+    front_buffer_.fill(ScreenCell{'\0'});
+}
+
+void ConsoleEngine::present() {
+    refresh_viewport();
+    FrameParams params{clip_, terminal_size_, scroll_hint_, erase_margins_};
+    scroll_hint_.reset();
+    erase_margins_ = false;
+    if (skipped_params_) {
+        params.absorb(*skipped_params_);
+        skipped_params_.reset();
+    }
+    // Внутри кадра игры вывод должен остаться в этом кадре
+    if (!render_thread_.is_running() || frame_depth_ > 0) {
+        // Терминал не успевает: кадр пропускается, а front-буфер по-прежнему
+        // описывает то, что действительно было отправлено
+        if (frame_depth_ == 0 &&
+            output_delay() > std::chrono::nanoseconds::zero()) {
+            skipped_params_ = params;
+            ++skipped_frames_;
+            return;
+        }
+        begin_frame();
+        append_frame(back_buffer_, params);
+        end_frame();
+        return;
+    }
+    FrameSnapshot& snapshot = render_thread_.next_frame();
+    snapshot.cells = back_buffer_;
+    snapshot.params = params;
+    render_thread_.publish();
+}
+
+// Выполняется и в потоке игры, и в потоке вывода, поэтому трогает только
+// front-буфер, состояние SGR, output_ и статистику и не вызывает публичные
+// методы, которые ждут поток вывода
+void ConsoleEngine::append_frame(const FrameBuffer& frame,
+                                 const FrameParams& params) {
+    apply_scroll_hint(frame, params);
+    const ClipRect& clip = params.clip;
+    uint32_t changed = 0;
+    int cursor_x = -1;
+    int cursor_y = -1;
+    for (int y = clip.y; y < clip.bottom(); ++y) {
+        for (int x = clip.x; x < clip.right(); ++x) {
+            const ScreenCell& cell = frame.at(x, y);
+            ScreenCell& shown = front_buffer_.at(x, y);
+            if (cell == shown) continue;
+            if (x != cursor_x || y != cursor_y) {
+                EscapeFormat::append_cursor_position(output_, x, y);
+                ++avoided_flushes_;
+            }
+            reset_pending_sgr();
+            apply_cell_style(cell);
+            sync_styles();
+            output_.push_back(cell.glyph);
+            shown = cell;
+            cursor_x = x + 1;
+            cursor_y = y;
+            ++changed;
+        }
+    }
+    reset_pending_sgr();
+    if (params.erase_margins && params.terminal_size)
+        append_margin_erase(frame, *params.terminal_size);
+    stats_.add_cells_changed(changed);
+}
+
+void ConsoleEngine::scroll_rows(int top, int bottom, int lines) {
+    wait_renderer();
+    shift_rows(clip_, top, bottom, lines);
+    commit(false);
+}
+
+void ConsoleEngine::shift_rows(const ClipRect& clip, int top, int bottom,
+                               int lines) {
+    // Область прокрутки не может выходить за экран
+    top = std::max(top, clip.y);
+    bottom = std::min(bottom, clip.bottom() - 1);
+    int count = std::min(std::abs(lines), bottom - top + 1);
+    if (count <= 0) return;
+    // Новые строки заполняются текущим фоном, поэтому стиль сбрасывается
+    reset_pending_sgr();
+    sync_styles();
+    append("\033[");
+    EscapeFormat::append_uint(output_, top + 1);
+    append(';');
+    EscapeFormat::append_uint(output_, bottom + 1);
+    append("r\033[");
+    EscapeFormat::append_uint(output_, count);
+    append(lines > 0 ? 'T' : 'S');
+    append("\033[r");
+
+    int width = front_buffer_.get_width();
+    if (lines > 0) {
+        for (int y = bottom; y >= top; --y) {
+            for (int x = 0; x < width; ++x) {
+                front_buffer_.at(x, y) = y - count >= top
+                                             ? front_buffer_.at(x, y - count)
+                                             : ScreenCell{};
+            }
+        }
+    } else {
+        for (int y = top; y <= bottom; ++y) {
+            for (int x = 0; x < width; ++x) {
+                front_buffer_.at(x, y) = y + count <= bottom
+                                             ? front_buffer_.at(x, y + count)
+                                             : ScreenCell{};
+            }
+        }
+    }
+}
+
+void ConsoleEngine::suggest_scroll(int top, int bottom, int lines) {
+    scroll_hint_ = ScrollHint{top, bottom, lines};
+}
+
+void ConsoleEngine::apply_scroll_hint(const FrameBuffer& frame,
+                                      const FrameParams& params) {
+    if (!params.scroll_hint) return;
+    const ScrollHint& hint = *params.scroll_hint;
+    const ClipRect& clip = params.clip;
+    int top = std::max(hint.top, clip.y);
+    int bottom = std::min(hint.bottom, clip.bottom() - 1);
+    if (hint.lines == 0 || top > bottom) return;
+    // DECSTBM, ESC[nT и сброс области — около полутора десятков байтов
+    constexpr int scroll_cost = 16;
+    if (estimate_rows_cost(frame, clip, top, bottom, hint.lines) + scroll_cost <
+        estimate_rows_cost(frame, clip, top, bottom, 0))
+        shift_rows(clip, top, bottom, hint.lines);
+}
+
+// Примерный объём вывода для строк top..bottom, если front-буфер сдвинуть
+// на shift строк: символ на клетку и перемещение курсора на каждый отрезок
+int ConsoleEngine::estimate_rows_cost(const FrameBuffer& frame,
+                                      const ClipRect& clip, int top,
+                                      int bottom, int shift) const {
+    constexpr int cursor_move_cost = 6;
+    const ScreenCell blank;
+    int cost = 0;
+    for (int y = top; y <= bottom; ++y) {
+        int source_y = y - shift;
+        bool inside = source_y >= top && source_y <= bottom;
+        bool in_run = false;
+        for (int x = clip.x; x < clip.right(); ++x) {
+            const ScreenCell& shown =
+                inside ? front_buffer_.at(x, source_y) : blank;
+            bool changed = !(frame.at(x, y) == shown);
+            if (changed) cost += in_run ? 1 : 1 + cursor_move_cost;
+            in_run = changed;
+        }
+    }
+    return cost;
+}
+
+void ConsoleEngine::apply_cell_style(const ScreenCell& cell) {
+    if (cell.style != ConsoleStyle::Reset)
+        pending_sgr_.styles |= 1 << static_cast<int>(cell.style);
+    if (cell.text_color) pending_sgr_.text_color = 256 + cell.text_color->id;
+    if (cell.background_color)
+        pending_sgr_.background_color = 256 + cell.background_color->id;
+}
+
 #ifdef _WIN32
 void ConsoleEngine::flush_input_buffer() {
     HANDLE h = GetStdHandle(STD_INPUT_HANDLE);
@@ -75,14 +733,151 @@ void ConsoleEngine::flush_input_buffer() {
 }
 #endif
 
+#ifdef _WIN32
+namespace {
+// _getch возвращает специальные клавиши парой байтов: 0 или 224 и скан-код
+KeyCode key_from_scan_code(int scan_code) {
+    switch (scan_code) {
+        case 72:
+            return KeyCode::Up;
+        case 80:
+            return KeyCode::Down;
+        case 77:
+            return KeyCode::Right;
+        case 75:
+            return KeyCode::Left;
+        case 71:
+            return KeyCode::Home;
+        case 79:
+            return KeyCode::End;
+        case 82:
+            return KeyCode::Insert;
+        case 83:
+            return KeyCode::Delete;
+        case 73:
+            return KeyCode::PageUp;
+        case 81:
+            return KeyCode::PageDown;
+        case 133:
+            return KeyCode::F11;
+        case 134:
+            return KeyCode::F12;
+        default:
+            if (scan_code >= 59 && scan_code <= 68)
+                return static_cast<KeyCode>(static_cast<int>(KeyCode::F1) +
+                                            scan_code - 59);
+            return KeyCode{0};
+    }
+}
+}  // namespace
+
+std::optional<KeyEvent> ConsoleEngine::read_input() {
+    while (::uni_kbhit()) {
+        auto now = std::chrono::steady_clock::now();
+        int c = static_cast<unsigned char>(::uni_getch());
+        if (c != 0 && c != 224)
+            return KeyEvent{KeyEvent::from_char(static_cast<char>(c)), 0, now};
+        KeyCode key =
+            key_from_scan_code(static_cast<unsigned char>(::uni_getch()));
+        if (key != KeyCode{0}) return KeyEvent{key, 0, now};
+    }
+    return std::nullopt;
+}
+#else
+std::optional<KeyEvent> ConsoleEngine::read_input() {
+    if (&cin_ != &std::cin) {
+        KeyEvent event;
+        while (cin_.rdbuf()->in_avail() > 0) {
+            char c = static_cast<char>(cin_.get());
+            if (decoder_.feed(c, std::chrono::steady_clock::now(), event))
+                return event;
+        }
+        // Конец доступных данных в потоке завершает последовательность
+        if (decoder_.finish(event)) return event;
+        return std::nullopt;
+    }
+    // Сессия захватывается при первом неблокирующем чтении, чтобы не мешать
+    // построчному вводу через get()
+    if (!input_session_) input_session_ = InputSession::acquire();
+    return input_session_->pop();
+}
+#endif
+
+void ConsoleEngine::poll_input() {
+    while (auto input = read_input()) {
+        recorder_.record_key(*input);
+        keyboard_.record(*input);
+        // Если события никто не читает через get_no_wait, новые отбрасываются
+        if (typed_tail_ - typed_head_ < typed_.size())
+            typed_[typed_tail_++ % typed_.size()] = *input;
+    }
+}
+
+std::optional<KeyEvent> ConsoleEngine::get_key_no_wait() {
+    poll_input();
+    if (typed_head_ == typed_tail_) return std::nullopt;
+    return typed_[typed_head_++ % typed_.size()];
+}
+
+char ConsoleEngine::get_no_wait() {
+    // Специальные клавиши символа не имеют и пропускаются
+    while (auto event = get_key_no_wait()) {
+        if (event->is_char()) return event->get_char();
+    }
+    return '\0';
+}
+
 #ifdef _WIN32
 bool ConsoleEngine::key_pressed(char key) {
     return GetAsyncKeyState(key) & 0x8000;
 }
 #else
-bool ConsoleEngine::key_pressed(char key){
-    // TODO: сделать поддержку
-    return get_no_wait() == key;
+bool ConsoleEngine::key_pressed(char key) {
+    return key_pressed(KeyEvent::from_char(key));
+}
+#endif
+
+bool ConsoleEngine::key_pressed(KeyCode key) {
+    poll_input();
+    return keyboard_.consume_press(key) ||
+           keyboard_.is_held(key, std::chrono::steady_clock::now());
+}
+
+bool ConsoleEngine::key_held(KeyCode key) {
+    poll_input();
+    return keyboard_.is_held(key, std::chrono::steady_clock::now());
+}
+
+KeySnapshot ConsoleEngine::snapshot_keys() {
+    poll_input();
+    return keyboard_.snapshot(std::chrono::steady_clock::now());
+}
+
+#ifdef _WIN32
+// В Windows ждать можно только сам дескриптор консоли, поэтому возвращается
+// номер stdin как признак того, что ввод идёт из терминала
+int ConsoleEngine::get_input_fd() { return &cin_ == &std::cin ? 0 : -1; }
+
+void ConsoleEngine::wait_input() {
+    poll_input();
+    if (typed_head_ != typed_tail_ || get_input_fd() == -1) return;
+    WaitForSingleObject(GetStdHandle(STD_INPUT_HANDLE), INFINITE);
+}
+#else
+int ConsoleEngine::get_input_fd() {
+    if (&cin_ != &std::cin) return -1;
+    if (!input_session_) input_session_ = InputSession::acquire();
+    return input_session_->ready_fd();
+}
+
+void ConsoleEngine::wait_input() {
+    poll_input();
+    if (typed_head_ != typed_tail_) return;
+    int fd = get_input_fd();
+    if (fd == -1) return;
+    pollfd ready{fd, POLLIN, 0};
+    while (poll(&ready, 1, -1) < 0 && errno == EINTR) {
+    }
 }
 #endif
 
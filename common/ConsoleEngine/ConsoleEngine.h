@@ -1,8 +1,28 @@
 #pragma once
+#include <array>
+#include <charconv>
 #include <iostream>
+#include <optional>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <cstdint>
 
+#include "ConsoleColors.h"
+#include "FrameBuffer.h"
+#include "InputDecoder.h"
+#include "InputSession.h"
+#include "KeyEvent.h"
+#include "KeyboardState.h"
+#include "OutputBacklog.h"
+#include "PrintFormat.h"
+#include "RenderStats.h"
+#include "RenderThread.h"
+#include "SessionLog.h"
+#include "SpectatorServer.h"
+#include "TerminalSize.h"
+
 #ifdef _WIN32
 #define NOMINMAX
 #include <conio.h>
@@ -10,135 +30,68 @@
 inline bool uni_kbhit() { return _kbhit() != 0; }
 inline char uni_getch() { return _getch(); }
 #else
-#include <stdio.h>
-#include <sys/select.h>
-#include <termios.h>
-#include <unistd.h>
-
-inline bool uni_kbhit() {
-    int ch = -1;
-    struct termios old_termios, new_termios;
-    tcgetattr(STDIN_FILENO, &old_termios);
-    new_termios = old_termios;
-    new_termios.c_lflag &= ~(ICANON | ECHO);
-    tcsetattr(STDIN_FILENO, TCSANOW, &new_termios);
-    fd_set read_fds;
-    FD_ZERO(&read_fds);
-    FD_SET(STDIN_FILENO, &read_fds);
-    struct timeval timeout = {0, 0};  // неблокирующий
-    int ready = select(STDIN_FILENO + 1, &read_fds, nullptr, nullptr, &timeout);
-    if (ready > 0 && FD_ISSET(STDIN_FILENO, &read_fds)) {
-        ch = getchar();
-        ungetc(ch, stdin);  // вернуть символ обратно
-    }
-    tcsetattr(STDIN_FILENO, TCSANOW, &old_termios);
-    return ch != -1;
-}
-
-inline char uni_getch() {
-    struct termios old_termios, new_termios;
-    tcgetattr(STDIN_FILENO, &old_termios);
-    new_termios = old_termios;
-    new_termios.c_lflag &= ~(ICANON | ECHO);
-    tcsetattr(STDIN_FILENO, TCSANOW, &new_termios);
-    char ch = getchar();
-    tcsetattr(STDIN_FILENO, TCSANOW, &old_termios);
-    return ch;
-}
+#include <memory>
 #endif
 
-enum class ConsoleStyle {
-    Reset = 0,
-    Bold = 1,
-    Underline = 4,
-    Inverse = 7,
-};
-enum class ConsoleTextColors {
-    Black = 30,
-    Red = 31,
-    Green = 32,
-    Yellow = 33,
-    Blue = 34,
-    Magenta = 35,
-    Cyan = 36,
-    White = 37,
-};
-enum class ConsoleBkgColors {
-    Black = 40,
-    Red = 41,
-    Green = 42,
-    Yellow = 43,
-    Blue = 44,
-    Magenta = 45,
-    Cyan = 46,
-    White = 47,
-};
-
-struct Color256 {
-    uint8_t id;
-    constexpr Color256(int i) : id(static_cast<uint8_t>(i)) {};
-};
-
-namespace Colors256{
-    constexpr Color256 Black{0};
-    constexpr Color256 Red{196};
-    constexpr Color256 Green{46};
-    constexpr Color256 Yellow{226};
-    constexpr Color256 Blue{21};
-    constexpr Color256 Magenta{201};
-    constexpr Color256 Cyan{51};
-    constexpr Color256 White{231};
-    constexpr Color256 Pink{198};
-    constexpr Color256 Orange{208};
-    constexpr Color256 Gray20{235};
-    constexpr Color256 Gray50{240};
-    constexpr Color256 Gray80{248};
-    constexpr Color256 DarkGreen{22};
-    constexpr Color256 GrayBrown{101};
-    constexpr Color256 LightBrown{136};
-    constexpr Color256 OrangeBrown{130};
-    constexpr Color256 Purple{92};
-}
-
 class ConsoleEngine {
   public:
     ConsoleEngine();
     ConsoleEngine(std::istream& in, std::ostream& out);
     ~ConsoleEngine();
+    // Потоки для движков, созданных конструктором по умолчанию. Так игру
+    // целиком можно запустить без терминала, например на HeadlessTerminal
+    static void set_default_streams(std::istream& in, std::ostream& out);
+    static void reset_default_streams();
+    // Настройки статистики для движков, созданных конструктором по умолчанию
+    static void set_default_stats_options(RenderStatsOptions options);
+    bool has_terminal() const;
     void clear();
     void set_cursor_to_zero();
     void set_cursor_to_pos(int x, int y);
     template <typename... Args>
-    void print(Args... args) {
-        ((cout_ << args), ...);
+    void print(const Args&... args) {
+        wait_renderer();
+        sync_styles();
+        (append(args), ...);
+        commit(false);
     };
+    // Формат проверяется при компиляции, аргументы не копируются, а текст
+    // пишется прямо в буфер вывода: при повторных кадрах ничего не выделяется
+    template <PrintFormat::FixedString Format, typename... Args>
+    void print_fmt(Args&&... args) {
+        wait_renderer();
+        sync_styles();
+        PrintFormat::format_to<Format>(output_, std::forward<Args>(args)...);
+        commit(false);
+    }
     template <typename... Args>
     void print_color(ConsoleTextColors text_color,
-                     ConsoleBkgColors background_color, Args... args) {
+                     ConsoleBkgColors background_color, const Args&... args) {
         set_color(text_color, background_color);
         print(args...);
         reset_styles();
     };
     template <typename... Args>
-    void print_color(ConsoleTextColors text_color, Args... args) {
+    void print_color(ConsoleTextColors text_color, const Args&... args) {
         set_color(text_color);
         print(args...);
         reset_styles();
     };
     template <typename... Args>
-    void print_color(ConsoleBkgColors background_color, Args... args) {
+    void print_color(ConsoleBkgColors background_color, const Args&... args) {
         set_color(background_color);
         print(args...);
         reset_styles();
     };
     template <typename... Args>
-    void print_color(Color256 text_color, Args... args) {
+    void print_color(Color256 text_color, const Args&... args) {
         set_text_color(text_color);
         print(args...);
         reset_styles();
     };
     template <typename... Args>
-    void print_color(Color256 text_color, Color256 background_color, Args... args) {
+    void print_color(Color256 text_color, Color256 background_color,
+                     const Args&... args) {
         set_text_color(text_color);
         set_background_color(background_color);
         print(args...);
@@ -154,12 +107,210 @@ class ConsoleEngine {
     void set_background_color(Color256 color);
     std::string get();
     char get_no_wait();
+    std::optional<KeyEvent> get_key_no_wait();
+    // Забирает одно ещё не прочитанное нажатие; удерживаемая клавиша тоже
+    // считается нажатой, поэтому после отпускания key_pressed возвращает
+    // true ещё до KeyboardState::release_timeout. Только нажатия — в
+    // snapshot_keys, только удержание — в key_held
     bool key_pressed(char key);
+    bool key_pressed(KeyCode key);
+    bool key_held(KeyCode key);
+    KeySnapshot snapshot_keys();
+    // Дескриптор, готовый к чтению при поступлении ввода, или -1, если ввод
+    // идёт не из терминала. Нужен циклу игры, чтобы ждать ввод вместе
+    // с таймером
+    int get_input_fd();
+    // Блокирует до появления ввода; без терминала возвращается сразу
+    void wait_input();
     void hide_cursor();
     void show_cursor();
+
+    void resize_frame(int width, int height);
+    // Размер экрана; nullopt, если вывод идёт не в терминал и размер не задан
+    std::optional<TerminalSize> get_terminal_size() const;
+    // Для вывода не в терминал (например, HeadlessTerminal) размер задаётся
+    // явно и применяется так же, как SIGWINCH: при следующем poll_resize
+    void set_terminal_size(TerminalSize size);
+    // true, если размер терминала изменился с прошлого вызова. Область
+    // отсечения уже пересчитана, видимые клетки помечены к перерисовке без
+    // очистки экрана; игре остаётся заново нарисовать то, что стало видно
+    bool poll_resize();
+    // Ограничивает вывод кадра прямоугольником (вдобавок к границам экрана)
+    void set_clip(const ClipRect& clip);
+    void reset_clip();
+    // Действующая область: кадр, экран и заданный прямоугольник вместе.
+    // draw_cell вне её ничего не делает, present её не обходит
+    const ClipRect& get_clip() const;
+    // Слой, на котором рисуют draw_cell, draw_text и draw_fmt. Пока рисуют
+    // только на Terrain, слои не заводятся и клетки пишутся прямо в кадр
+    void set_layer(Layer layer);
+    Layer get_layer() const;
+    // Делает прямоугольник слоя прозрачным (Terrain — пустым); кадр в нём
+    // собирается из нижних слоёв, и present отправит только эти клетки
+    void clear_layer(Layer layer, const ClipRect& rect);
+    void draw_cell(int x, int y, const ScreenCell& cell);
+    void draw_text(int x, int y, std::string_view text,
+                   std::optional<Color256> text_color = std::nullopt,
+                   std::optional<Color256> background_color = std::nullopt);
+    // draw_text по формату, как print_fmt
+    template <PrintFormat::FixedString Format, typename... Args>
+    void draw_fmt(int x, int y, Args&&... args) {
+        format_buffer_.clear();
+        PrintFormat::format_to<Format>(format_buffer_,
+                                       std::forward<Args>(args)...);
+        draw_text(x, y, format_buffer_);
+    }
+    void invalidate();
+    void present();
+    // Сдвигает строки top..bottom экрана на lines вниз (lines < 0 — вверх)
+    // средствами терминала: DECSTBM и ESC[T / ESC[S. Front-буфер сдвигается
+    // так же, и следующий present отправит только то, что не совпало
+    void scroll_rows(int top, int bottom, int lines);
+    // То же, но решение принимает следующий present: прокрутка выполняется,
+    // только если с ней кадр выходит дешевле
+    void suggest_scroll(int top, int bottom, int lines);
+
+    void begin_frame();
+    void end_frame();
+    uint64_t get_avoided_flushes() const;
+
+    // Вывод кадров в отдельном потоке: present только публикует снимок кадра
+    // и не ждёт терминал. Любой другой вывод сначала дожидается, пока поток
+    // отправит опубликованное, поэтому порядок на экране не меняется. С
+    // терминалом включается при создании движка
+    void set_render_thread(bool enabled);
+    // Кадры, которые не были выведены: их заменил более новый кадр, потому
+    // что терминал не успевал
+    uint64_t get_dropped_frames() const;
+    // Если терминал отстаёт больше чем на budget, промежуточные кадры
+    // пропускаются, а следующий отправляет разницу с тем, что действительно
+    // ушло в терминал
+    void set_latency_budget(std::chrono::nanoseconds budget);
+    // Для вывода в терминал очередь берётся из stdout; для других потоков
+    // её можно задать явно
+    void set_output_backlog(OutputBacklog backlog);
+
+    // Весь вывод в терминал дублируется зрителям, подключившимся к
+    // Unix-сокету path; новый зритель сначала получает весь экран
+    bool start_spectators(const std::string& path);
+    void stop_spectators();
+    size_t get_spectator_count() const;
+
+    // Журнал сеанса (SessionLog.h): весь вывод в терминал, ввод и размеры
+    // экрана с метками времени. Проигрывается SessionReplayer. Следующий
+    // present перерисует кадр целиком, чтобы журнал начинался с него
+    bool start_recording(const std::string& path);
+    void stop_recording();
+
+    void set_stats_options(RenderStatsOptions options);
+    const FrameStats& get_last_frame_stats() const;
+    const std::vector<FrameStats>& get_frame_stats() const;
+
   private:
+    struct SgrState {
+        // 0 — цвет по умолчанию, базовые цвета хранятся кодом SGR,
+        // цвета палитры 256 — как 256 + id
+        int text_color = 0;
+        int background_color = 0;
+        uint8_t styles = 0;
+        constexpr bool operator==(const SgrState& other) const = default;
+    };
+
     std::istream& cin_;
     std::ostream& cout_;
+    FrameBuffer back_buffer_;
+    FrameBuffer front_buffer_;
+    std::string output_;
+    // Текст draw_fmt; ёмкость сохраняется между кадрами
+    std::string format_buffer_;
+    // Слои заводятся при первом рисовании выше Terrain; back_buffer_
+    // остаётся их готовой сборкой
+    std::array<FrameBuffer, layer_count> layers_;
+    bool layered_ = false;
+    Layer layer_ = Layer::Terrain;
+    int frame_depth_ = 0;
+    uint64_t avoided_flushes_ = 0;
+    std::optional<ScrollHint> scroll_hint_;
+    std::optional<TerminalSize> terminal_size_;
+    std::optional<ClipRect> user_clip_;
+    ClipRect clip_;
+    uint32_t resize_generation_ = 0;
+    // Размер, заданный set_terminal_size и ещё не применённый
+    std::optional<TerminalSize> requested_size_;
+    // Об изменении размера ещё не сообщил poll_resize
+    bool resize_unreported_ = false;
+    // После изменения размера стираются поля экрана вне кадра
+    bool erase_margins_ = false;
+    RenderStats stats_;
+#ifndef _WIN32
+    std::shared_ptr<InputSession> input_session_;
+#endif
+    InputDecoder decoder_;
+    KeyboardState keyboard_;
+    std::array<KeyEvent, 256> typed_{};
+    size_t typed_head_ = 0;
+    size_t typed_tail_ = 0;
+    SgrState pending_sgr_;
+    SgrState current_sgr_;
+    bool sgr_known_ = false;
+    OutputBacklog backlog_;
+    std::chrono::nanoseconds latency_budget_ = std::chrono::milliseconds(50);
+    // Подсказки пропущенного кадра переходят к следующему
+    std::optional<FrameParams> skipped_params_;
+    uint64_t skipped_frames_ = 0;
+    SpectatorServer spectators_;
+    SessionRecorder recorder_;
+    // Последний член: копия движка начинает без потока вывода
+    RenderThread render_thread_;
+
+    void wait_renderer() const;
+    std::chrono::nanoseconds output_delay() const;
+    void append_frame(const FrameBuffer& frame, const FrameParams& params);
+    void flush_frame(const FrameBuffer& frame,
+                     const std::optional<TerminalSize>& screen);
+    void reset_pending_sgr();
+    void apply_cell_style(const ScreenCell& cell);
+    void shift_rows(const ClipRect& clip, int top, int bottom, int lines);
+    int estimate_rows_cost(const FrameBuffer& frame, const ClipRect& clip,
+                           int top, int bottom, int shift) const;
+    void apply_scroll_hint(const FrameBuffer& frame, const FrameParams& params);
+    void refresh_viewport();
+    void enable_layers();
+    void compose_cell(int x, int y);
+    void update_clip();
+    void append_margin_erase(const FrameBuffer& frame,
+                             const TerminalSize& screen);
+
+    template <typename T>
+    void append(const T& value) {
+        if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+                      std::is_same_v<T, unsigned char>) {
+            output_.push_back(static_cast<char>(value));
+        } else if constexpr (std::is_same_v<T, bool>) {
+            output_.push_back(value ? '1' : '0');
+        } else if constexpr (std::is_integral_v<T>) {
+            char digits[24];
+            auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            output_.append(digits, result.ptr);
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            output_.append(std::string_view(value));
+        } else {
+            std::ostringstream stream;
+            stream << value;
+            output_.append(stream.str());
+        }
+    }
+    void sync_styles();
+    void append_sgr_param(int value, bool& first);
+    void append_sgr_color(int color, int extended_code, bool& first);
+    void commit(bool flush);
+    void write_to_terminal();
+    void publish_output(bool flushed);
+    void append_stats_overlay(const FrameBuffer& frame,
+                              const std::optional<TerminalSize>& screen);
+
+    std::optional<KeyEvent> read_input();
+    void poll_input();
 
     void flush_input_buffer();
     void enableAnsiColors();
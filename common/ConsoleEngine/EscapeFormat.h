@@ -0,0 +1,105 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Форматирование escape-последовательностей без iostream: параметры цветов
+// палитры 256 заранее посчитаны при компиляции, числа пишутся по таблице пар
+// цифр прямо в выходной буфер
+namespace EscapeFormat {
+
+struct SgrParam {
+    std::array<char, 8> data{};
+    uint8_t size = 0;
+    constexpr std::string_view view() const { return {data.data(), size}; }
+};
+
+constexpr SgrParam make_color_param(int extended_code, int id) {
+    SgrParam param;
+    auto put = [&](char c) { param.data[param.size++] = c; };
+    put(static_cast<char>('0' + extended_code / 10));
+    put(static_cast<char>('0' + extended_code % 10));
+    put(';');
+    put('5');
+    put(';');
+    if (id >= 100) put(static_cast<char>('0' + id / 100));
+    if (id >= 10) put(static_cast<char>('0' + id / 10 % 10));
+    put(static_cast<char>('0' + id % 10));
+    return param;
+}
+
+constexpr std::array<SgrParam, 256> make_color_table(int extended_code) {
+    std::array<SgrParam, 256> table{};
+    for (int id = 0; id < 256; ++id) {
+        table[id] = make_color_param(extended_code, id);
+    }
+    return table;
+}
+
+// "38;5;N" и "48;5;N" для всех цветов Color256
+inline constexpr std::array<SgrParam, 256> text_color_params =
+    make_color_table(38);
+inline constexpr std::array<SgrParam, 256> background_color_params =
+    make_color_table(48);
+
+inline constexpr char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+constexpr int count_digits(uint32_t value) {
+    return 1 + (value >= 10) + (value >= 100) + (value >= 1000) +
+           (value >= 10000) + (value >= 100000) + (value >= 1000000) +
+           (value >= 10000000) + (value >= 100000000) + (value >= 1000000000);
+}
+
+// Записывает число в out и возвращает указатель за последней цифрой
+inline char* write_uint(char* out, uint32_t value) {
+    char* end = out + count_digits(value);
+    char* p = end;
+    while (value >= 100) {
+        uint32_t pair = (value % 100) * 2;
+        value /= 100;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    }
+    if (value >= 10) {
+        *--p = digit_pairs[value * 2 + 1];
+        *--p = digit_pairs[value * 2];
+    } else {
+        *--p = static_cast<char>('0' + value);
+    }
+    return end;
+}
+
+inline void append_uint(std::string& out, uint32_t value) {
+    size_t old_size = out.size();
+    out.resize(old_size + 10);
+    char* end = write_uint(out.data() + old_size, value);
+    out.resize(end - out.data());
+}
+
+// "\033[<y+1>;<x+1>H"
+inline void append_cursor_position(std::string& out, int x, int y) {
+    size_t old_size = out.size();
+    out.resize(old_size + 24);
+    char* p = out.data() + old_size;
+    *p++ = '\033';
+    *p++ = '[';
+    p = write_uint(p, static_cast<uint32_t>(std::max(y + 1, 1)));
+    *p++ = ';';
+    p = write_uint(p, static_cast<uint32_t>(std::max(x + 1, 1)));
+    *p++ = 'H';
+    out.resize(p - out.data());
+}
+
+}  // namespace EscapeFormat
@@ -0,0 +1,27 @@
+#include "FrameBuffer.h"
+
+#include <algorithm>
+
+FrameBuffer::FrameBuffer(int width, int height) { resize(width, height); }
+
+void FrameBuffer::resize(int width, int height) {
+    width_ = width;
+    height_ = height;
+    cells_.assign(static_cast<size_t>(width) * height, ScreenCell{});
+}
+
+void FrameBuffer::fill(const ScreenCell& cell) {
+    std::fill(cells_.begin(), cells_.end(), cell);
+}
+
+bool FrameBuffer::contains(int x, int y) const {
+    return x >= 0 && y >= 0 && x < width_ && y < height_;
+}
+
+ScreenCell& FrameBuffer::at(int x, int y) { return cells_[y * width_ + x]; }
+const ScreenCell& FrameBuffer::at(int x, int y) const {
+    return cells_[y * width_ + x];
+}
+
+int FrameBuffer::get_width() const { return width_; }
+int FrameBuffer::get_height() const { return height_; }
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "ConsoleColors.h"
+
+struct ScreenCell {
+    char glyph = ' ';
+    std::optional<Color256> text_color;
+    std::optional<Color256> background_color;
+    ConsoleStyle style = ConsoleStyle::Reset;
+    constexpr bool operator==(const ScreenCell& other) const = default;
+};
+
+// Слои кадра снизу вверх. В клетке кадра виден верхний непрозрачный слой;
+// прозрачна клетка слоя с glyph '\0'
+enum class Layer : uint8_t {
+    Terrain,
+    Entity,
+    Actor,
+    Overlay,
+};
+inline constexpr size_t layer_count = 4;
+
+class FrameBuffer {
+  public:
+    FrameBuffer() = default;
+    FrameBuffer(int width, int height);
+    void resize(int width, int height);
+    void fill(const ScreenCell& cell);
+    bool contains(int x, int y) const;
+    ScreenCell& at(int x, int y);
+    const ScreenCell& at(int x, int y) const;
+    int get_width() const;
+    int get_height() const;
+
+  private:
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<ScreenCell> cells_;
+};
@@ -0,0 +1,63 @@
+#include "GameOptions.h"
+
+#include <charconv>
+#include <string_view>
+
+namespace {
+constexpr std::string_view headless_flag = "-headless";
+constexpr std::string_view stats_flag = "-stats=";
+constexpr std::string_view spectate_flag = "-spectate=";
+constexpr std::string_view record_flag = "-record=";
+constexpr int default_headless_frames = 1000;
+
+// Всё значение должно быть неотрицательным числом: "12abc" — ошибка, а
+// не 12 кадров
+std::optional<int> parse_frames(std::string_view value) {
+    int frames = 0;
+    auto [end, error] =
+        std::from_chars(value.data(), value.data() + value.size(), frames);
+    if (error != std::errc{} || end != value.data() + value.size() ||
+        frames < 0)
+        return std::nullopt;
+    return frames;
+}
+}  // namespace
+
+std::optional<GameOptions> GameOptions::parse(int argc, char* argv[],
+                                              std::ostream& err) {
+    GameOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == headless_flag) {
+            options.headless_frames = default_headless_frames;
+        } else if (arg.starts_with(headless_flag) &&
+                   arg[headless_flag.size()] == '=') {
+            options.headless_frames =
+                parse_frames(arg.substr(headless_flag.size() + 1));
+            if (!options.headless_frames) {
+                err << "Invalid frame count in " << arg << std::endl;
+                print_usage(err);
+                return std::nullopt;
+            }
+        } else if (arg.starts_with(stats_flag)) {
+            options.stats.csv_path = arg.substr(stats_flag.size());
+        } else if (arg.starts_with(spectate_flag)) {
+            options.spectate_path = arg.substr(spectate_flag.size());
+        } else if (arg.starts_with(record_flag)) {
+            options.record_path = arg.substr(record_flag.size());
+        } else if (arg == "-overlay") {
+            options.stats.overlay = true;
+        }
+    }
+    return options;
+}
+
+void GameOptions::print_usage(std::ostream& out) {
+    out << "Options:\n"
+           "  -headless[=N]    play N frames (default 1000) without a "
+           "terminal\n"
+           "  -stats=FILE      write frame statistics as CSV on exit\n"
+           "  -overlay         show frame statistics under the field\n"
+           "  -spectate=PATH   broadcast the game on Unix socket PATH\n"
+           "  -record=FILE     record output and input for replay\n";
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <optional>
+#include <ostream>
+#include <string>
+
+#include "RenderStats.h"
+
+// Общие ключи командной строки игр:
+// -headless[=N]: N кадров (по умолчанию 1000) без терминала, затем итоговый
+//   экран и счётчики
+// -stats=FILE: статистика кадров в CSV при выходе
+// -overlay: строка статистики под полем
+// -spectate=PATH: трансляция игры зрителям через Unix-сокет PATH
+// -record=FILE: журнал вывода и ввода для ConsoleEngineReplay
+// Незнакомые ключи пропускаются: их может разбирать сама игра
+struct GameOptions {
+    std::optional<int> headless_frames;
+    std::string spectate_path;
+    std::string record_path;
+    RenderStatsOptions stats;
+
+    // nullopt, если значение ключа не разобрано; ошибка и подсказка по
+    // ключам уже выведены в err
+    static std::optional<GameOptions> parse(int argc, char* argv[],
+                                            std::ostream& err);
+    static void print_usage(std::ostream& out);
+
+    // Трансляция и запись начинаются, когда игра уже создана; неудача не
+    // мешает играть
+    template <typename Game>
+    void start_outputs(Game& game, std::ostream& err) const {
+        if (!spectate_path.empty() && !game.spectate(spectate_path))
+            err << "Cannot listen on " << spectate_path << std::endl;
+        if (!record_path.empty() && !game.record(record_path))
+            err << "Cannot write " << record_path << std::endl;
+    }
+};
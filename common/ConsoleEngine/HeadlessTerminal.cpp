@@ -0,0 +1,340 @@
+#include "HeadlessTerminal.h"
+
+#include <algorithm>
+
+namespace {
+constexpr char escape_byte = '\033';
+}  // namespace
+
+HeadlessTerminal::HeadlessTerminal(int width, int height)
+    : stream_(this), screen_(width, height), scroll_bottom_(height - 1) {}
+
+std::ostream& HeadlessTerminal::stream() { return stream_; }
+
+void HeadlessTerminal::resize(int width, int height) {
+    FrameBuffer resized(width, height);
+    for (int y = 0; y < std::min(height, screen_.get_height()); ++y) {
+        for (int x = 0; x < std::min(width, screen_.get_width()); ++x) {
+            resized.at(x, y) = screen_.at(x, y);
+        }
+    }
+    screen_ = std::move(resized);
+    cursor_x_ = std::min(cursor_x_, width - 1);
+    cursor_y_ = std::min(cursor_y_, height - 1);
+    scroll_top_ = 0;
+    scroll_bottom_ = height - 1;
+}
+
+const FrameBuffer& HeadlessTerminal::get_screen() const { return screen_; }
+
+const ScreenCell& HeadlessTerminal::at(int x, int y) const {
+    return screen_.at(x, y);
+}
+
+std::string HeadlessTerminal::row_text(int y) const {
+    std::string text;
+    text.reserve(screen_.get_width());
+    for (int x = 0; x < screen_.get_width(); ++x) {
+        text.push_back(screen_.at(x, y).glyph);
+    }
+    return text;
+}
+
+int HeadlessTerminal::get_cursor_x() const { return cursor_x_; }
+int HeadlessTerminal::get_cursor_y() const { return cursor_y_; }
+bool HeadlessTerminal::is_cursor_visible() const { return cursor_visible_; }
+
+const HeadlessTerminal::Counters& HeadlessTerminal::get_totals() const {
+    return totals_;
+}
+const HeadlessTerminal::Counters& HeadlessTerminal::get_last_frame() const {
+    return last_frame_;
+}
+uint64_t HeadlessTerminal::get_frame_count() const { return frame_count_; }
+
+void HeadlessTerminal::reset_counters() {
+    totals_ = Counters{};
+    frame_ = Counters{};
+    last_frame_ = Counters{};
+    frame_count_ = 0;
+}
+
+void HeadlessTerminal::write_report(std::ostream& out) const {
+    for (int y = 0; y < screen_.get_height(); ++y) {
+        out << row_text(y) << '\n';
+    }
+    double frames = frame_count_ > 0 ? static_cast<double>(frame_count_) : 1.0;
+    out << "frames: " << frame_count_ << "\n"
+        << "bytes: " << totals_.bytes << " (" << totals_.bytes / frames
+        << " per frame)\n"
+        << "sequences: " << totals_.sequences << " ("
+        << totals_.sequences / frames << " per frame)\n"
+        << "cells touched: " << totals_.cells_touched << " ("
+        << totals_.cells_touched / frames << " per frame)\n";
+}
+
+HeadlessTerminal::int_type HeadlessTerminal::overflow(int_type ch) {
+    if (traits_type::eq_int_type(ch, traits_type::eof()))
+        return traits_type::not_eof(ch);
+    feed(traits_type::to_char_type(ch));
+    return ch;
+}
+
+std::streamsize HeadlessTerminal::xsputn(const char* data,
+                                         std::streamsize count) {
+    for (std::streamsize i = 0; i < count; ++i) {
+        feed(data[i]);
+    }
+    return count;
+}
+
+int HeadlessTerminal::sync() {
+    if (frame_.bytes == 0) return 0;
+    last_frame_ = frame_;
+    frame_ = Counters{};
+    ++frame_count_;
+    return 0;
+}
+
+void HeadlessTerminal::feed(char byte) {
+    ++totals_.bytes;
+    ++frame_.bytes;
+    switch (state_) {
+        case State::Ground:
+            if (byte == escape_byte) {
+                state_ = State::Escape;
+            } else if (byte == '\n') {
+                // Как терминал с включённым ONLCR: перевод строки с возвратом
+                cursor_x_ = 0;
+                line_feed();
+            } else if (byte == '\r') {
+                cursor_x_ = 0;
+            } else if (byte == '\b') {
+                cursor_x_ = std::max(0, cursor_x_ - 1);
+            } else if (static_cast<unsigned char>(byte) >= 0x20) {
+                put_glyph(byte);
+            }
+            return;
+        case State::Escape:
+            if (byte == '[') {
+                state_ = State::Csi;
+                params_.fill(0);
+                param_count_ = 0;
+                private_marker_ = false;
+                return;
+            }
+            if (byte == '7') {
+                saved_cursor_x_ = cursor_x_;
+                saved_cursor_y_ = cursor_y_;
+                saved_pen_ = pen_;
+            } else if (byte == '8') {
+                cursor_x_ = saved_cursor_x_;
+                cursor_y_ = saved_cursor_y_;
+                pen_ = saved_pen_;
+            }
+            ++totals_.sequences;
+            ++frame_.sequences;
+            state_ = State::Ground;
+            return;
+        case State::Csi:
+            if (byte >= '0' && byte <= '9') {
+                if (param_count_ == 0) param_count_ = 1;
+                int& value = params_[param_count_ - 1];
+                if (value < 100000) value = value * 10 + (byte - '0');
+            } else if (byte == ';') {
+                if (param_count_ == 0) param_count_ = 1;
+                if (param_count_ < max_params) ++param_count_;
+            } else if (byte >= 0x40 && byte <= 0x7E) {
+                state_ = State::Ground;
+                ++totals_.sequences;
+                ++frame_.sequences;
+                execute_csi(byte);
+            } else {
+                private_marker_ = true;
+            }
+            return;
+    }
+}
+
+void HeadlessTerminal::put_glyph(char glyph) {
+    // Перенос откладывается до следующего символа, как в xterm
+    if (cursor_x_ >= screen_.get_width()) {
+        cursor_x_ = 0;
+        line_feed();
+    }
+    ScreenCell& cell = screen_.at(cursor_x_, cursor_y_);
+    cell = pen_;
+    cell.glyph = glyph;
+    ++cursor_x_;
+    ++totals_.cells_touched;
+    ++frame_.cells_touched;
+}
+
+void HeadlessTerminal::line_feed() {
+    if (cursor_y_ == scroll_bottom_)
+        scroll_up(1);
+    else if (cursor_y_ + 1 < screen_.get_height())
+        ++cursor_y_;
+}
+
+// Прокрутка действует только внутри области DECSTBM
+void HeadlessTerminal::scroll_up(int lines) {
+    int width = screen_.get_width();
+    lines = std::min(lines, scroll_bottom_ - scroll_top_ + 1);
+    for (int y = scroll_top_; y + lines <= scroll_bottom_; ++y) {
+        for (int x = 0; x < width; ++x) {
+            screen_.at(x, y) = screen_.at(x, y + lines);
+        }
+    }
+    erase(0, scroll_bottom_ - lines + 1, width - 1, scroll_bottom_);
+}
+
+void HeadlessTerminal::scroll_down(int lines) {
+    int width = screen_.get_width();
+    lines = std::min(lines, scroll_bottom_ - scroll_top_ + 1);
+    for (int y = scroll_bottom_; y - lines >= scroll_top_; --y) {
+        for (int x = 0; x < width; ++x) {
+            screen_.at(x, y) = screen_.at(x, y - lines);
+        }
+    }
+    erase(0, scroll_top_, width - 1, scroll_top_ + lines - 1);
+}
+
+int HeadlessTerminal::param(int index, int default_value) const {
+    if (index >= param_count_ || params_[index] == 0) return default_value;
+    return params_[index];
+}
+
+void HeadlessTerminal::execute_csi(char final_byte) {
+    int width = screen_.get_width();
+    int height = screen_.get_height();
+    if (private_marker_) {
+        // Из приватных режимов важна только видимость курсора: ?25h / ?25l
+        if (param(0, 0) == 25 && (final_byte == 'h' || final_byte == 'l'))
+            cursor_visible_ = final_byte == 'h';
+        return;
+    }
+    switch (final_byte) {
+        case 'H':
+        case 'f':
+            cursor_y_ = std::clamp(param(0, 1) - 1, 0, height - 1);
+            cursor_x_ = std::clamp(param(1, 1) - 1, 0, width - 1);
+            break;
+        case 'A':
+            cursor_y_ = std::max(0, cursor_y_ - param(0, 1));
+            break;
+        case 'B':
+            cursor_y_ = std::min(height - 1, cursor_y_ + param(0, 1));
+            break;
+        case 'C':
+            cursor_x_ = std::min(width - 1, cursor_x_ + param(0, 1));
+            break;
+        case 'D':
+            cursor_x_ = std::max(0, std::min(cursor_x_, width - 1) - param(0, 1));
+            break;
+        case 'G':
+            cursor_x_ = std::clamp(param(0, 1) - 1, 0, width - 1);
+            break;
+        case 'J':
+            erase_display(param(0, 0));
+            break;
+        case 'K':
+            erase_line(param(0, 0));
+            break;
+        case 'm':
+            apply_sgr();
+            break;
+        case 'r': {
+            int top = param(0, 1) - 1;
+            int bottom = param(1, height) - 1;
+            if (top < bottom && bottom < height) {
+                scroll_top_ = top;
+                scroll_bottom_ = bottom;
+            }
+            cursor_x_ = 0;
+            cursor_y_ = 0;
+            break;
+        }
+        case 'S':
+            scroll_up(param(0, 1));
+            break;
+        case 'T':
+            scroll_down(param(0, 1));
+            break;
+        default:
+            break;
+    }
+}
+
+void HeadlessTerminal::apply_sgr() {
+    int count = std::max(param_count_, 1);
+    for (int i = 0; i < count; ++i) {
+        int code = params_[i];
+        if (code == 0) {
+            pen_ = ScreenCell{};
+        } else if (code == 1 || code == 4 || code == 7) {
+            pen_.style = static_cast<ConsoleStyle>(code);
+        } else if (code >= 30 && code <= 37) {
+            pen_.text_color = Color256{code - 30};
+        } else if (code >= 90 && code <= 97) {
+            pen_.text_color = Color256{code - 90 + 8};
+        } else if (code == 39) {
+            pen_.text_color.reset();
+        } else if (code >= 40 && code <= 47) {
+            pen_.background_color = Color256{code - 40};
+        } else if (code >= 100 && code <= 107) {
+            pen_.background_color = Color256{code - 100 + 8};
+        } else if (code == 49) {
+            pen_.background_color.reset();
+        } else if ((code == 38 || code == 48) && i + 2 < count &&
+                   params_[i + 1] == 5) {
+            Color256 color{params_[i + 2] & 0xFF};
+            if (code == 38)
+                pen_.text_color = color;
+            else
+                pen_.background_color = color;
+            i += 2;
+        }
+    }
+}
+
+void HeadlessTerminal::erase_display(int mode) {
+    int width = screen_.get_width();
+    int height = screen_.get_height();
+    int x = std::min(cursor_x_, width - 1);
+    if (mode == 0)
+        erase(x, cursor_y_, width - 1, height - 1);
+    else if (mode == 1)
+        erase(0, 0, x, cursor_y_);
+    else
+        erase(0, 0, width - 1, height - 1);
+}
+
+void HeadlessTerminal::erase_line(int mode) {
+    int width = screen_.get_width();
+    int x = std::min(cursor_x_, width - 1);
+    if (mode == 0)
+        erase(x, cursor_y_, width - 1, cursor_y_);
+    else if (mode == 1)
+        erase(0, cursor_y_, x, cursor_y_);
+    else
+        erase(0, cursor_y_, width - 1, cursor_y_);
+}
+
+// Очищает клетки от (from_x, from_y) до (to_x, to_y) включительно в порядке
+// вывода; очищенные клетки получают текущий цвет фона
+void HeadlessTerminal::erase(int from_x, int from_y, int to_x, int to_y) {
+    ScreenCell blank;
+    blank.background_color = pen_.background_color;
+    int width = screen_.get_width();
+    for (int y = from_y; y <= to_y; ++y) {
+        int first = y == from_y ? from_x : 0;
+        int last = y == to_y ? to_x : width - 1;
+        for (int x = first; x <= last; ++x) {
+            screen_.at(x, y) = blank;
+        }
+        int touched = std::max(0, last - first + 1);
+        totals_.cells_touched += touched;
+        frame_.cells_touched += touched;
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+#include "FrameBuffer.h"
+
+// Терминал в памяти: разбирает вывод ConsoleEngine (перемещения курсора,
+// SGR, очистку) в сетку клеток и считает стоимость вывода. Кадром считается
+// всё, что записано между двумя сбросами потока
+class HeadlessTerminal : private std::streambuf {
+  public:
+    struct Counters {
+        uint64_t bytes = 0;
+        uint64_t sequences = 0;
+        uint64_t cells_touched = 0;
+    };
+
+    HeadlessTerminal(int width, int height);
+    HeadlessTerminal(const HeadlessTerminal&) = delete;
+    HeadlessTerminal& operator=(const HeadlessTerminal&) = delete;
+
+    std::ostream& stream();
+    // Как окно терминала без переноса строк: видимое содержимое остаётся на
+    // месте, новые клетки пустые, область прокрутки сбрасывается
+    void resize(int width, int height);
+
+    const FrameBuffer& get_screen() const;
+    const ScreenCell& at(int x, int y) const;
+    std::string row_text(int y) const;
+    int get_cursor_x() const;
+    int get_cursor_y() const;
+    bool is_cursor_visible() const;
+
+    const Counters& get_totals() const;
+    const Counters& get_last_frame() const;
+    uint64_t get_frame_count() const;
+    void reset_counters();
+    void write_report(std::ostream& out) const;
+
+  private:
+    enum class State : uint8_t { Ground, Escape, Csi };
+    static constexpr int max_params = 16;
+
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* data, std::streamsize count) override;
+    int sync() override;
+
+    void feed(char byte);
+    void put_glyph(char glyph);
+    void line_feed();
+    void scroll_up(int lines);
+    void scroll_down(int lines);
+    void execute_csi(char final_byte);
+    void apply_sgr();
+    void erase_display(int mode);
+    void erase_line(int mode);
+    void erase(int from_x, int from_y, int to_x, int to_y);
+    int param(int index, int default_value) const;
+
+    std::ostream stream_;
+    FrameBuffer screen_;
+    ScreenCell pen_;
+    int cursor_x_ = 0;
+    int cursor_y_ = 0;
+    bool cursor_visible_ = true;
+    // Область прокрутки (DECSTBM), строки включительно
+    int scroll_top_ = 0;
+    int scroll_bottom_ = 0;
+    // Сохранённые ESC 7 курсор и атрибуты
+    int saved_cursor_x_ = 0;
+    int saved_cursor_y_ = 0;
+    ScreenCell saved_pen_;
+
+    State state_ = State::Ground;
+    std::array<int, max_params> params_{};
+    int param_count_ = 0;
+    bool private_marker_ = false;
+
+    Counters totals_;
+    Counters frame_;
+    Counters last_frame_;
+    uint64_t frame_count_ = 0;
+};
@@ -0,0 +1,164 @@
+#include "InputDecoder.h"
+
+namespace {
+constexpr char escape_byte = '\033';
+
+// Последний байт последовательности CSI/SS3 -> клавиша
+constexpr std::array<KeyCode, 128> make_final_table() {
+    std::array<KeyCode, 128> table{};
+    table['A'] = KeyCode::Up;
+    table['B'] = KeyCode::Down;
+    table['C'] = KeyCode::Right;
+    table['D'] = KeyCode::Left;
+    table['H'] = KeyCode::Home;
+    table['F'] = KeyCode::End;
+    table['P'] = KeyCode::F1;
+    table['Q'] = KeyCode::F2;
+    table['R'] = KeyCode::F3;
+    table['S'] = KeyCode::F4;
+    table['Z'] = KeyCode::Tab;
+    return table;
+}
+constexpr auto final_table = make_final_table();
+
+// Числовой параметр последовательности вида CSI n ~ -> клавиша
+constexpr std::array<KeyCode, 25> make_tilde_table() {
+    std::array<KeyCode, 25> table{};
+    table[1] = KeyCode::Home;
+    table[2] = KeyCode::Insert;
+    table[3] = KeyCode::Delete;
+    table[4] = KeyCode::End;
+    table[5] = KeyCode::PageUp;
+    table[6] = KeyCode::PageDown;
+    table[7] = KeyCode::Home;
+    table[8] = KeyCode::End;
+    table[11] = KeyCode::F1;
+    table[12] = KeyCode::F2;
+    table[13] = KeyCode::F3;
+    table[14] = KeyCode::F4;
+    table[15] = KeyCode::F5;
+    table[17] = KeyCode::F6;
+    table[18] = KeyCode::F7;
+    table[19] = KeyCode::F8;
+    table[20] = KeyCode::F9;
+    table[21] = KeyCode::F10;
+    table[23] = KeyCode::F11;
+    table[24] = KeyCode::F12;
+    return table;
+}
+constexpr auto tilde_table = make_tilde_table();
+
+// В xterm модификаторы передаются как 1 + битовая маска
+uint8_t modifiers_from_param(int param) {
+    if (param <= 1) return KeyModifiers::None;
+    return static_cast<uint8_t>((param - 1) & 0x7);
+}
+}  // namespace
+
+bool InputDecoder::feed(char byte, Clock::time_point time, KeyEvent& event) {
+    switch (state_) {
+        case State::Ground:
+            if (byte == escape_byte) {
+                state_ = State::Escape;
+                started_ = time;
+                return false;
+            }
+            started_ = time;
+            // При включённом ICRNL Enter приходит как '\n'
+            if (byte == '\n') byte = '\r';
+            return emit(KeyEvent::from_char(byte), KeyModifiers::None, event);
+        case State::Escape:
+            if (byte == '[' || byte == 'O') {
+                state_ = byte == '[' ? State::Csi : State::Ss3;
+                params_.fill(0);
+                param_count_ = 0;
+                private_marker_ = false;
+                return false;
+            }
+            if (byte == escape_byte) {
+                // Два Esc подряд: первый — отдельное нажатие
+                emit(KeyCode::Escape, KeyModifiers::None, event);
+                state_ = State::Escape;
+                started_ = time;
+                return true;
+            }
+            state_ = State::Ground;
+            return emit(KeyEvent::from_char(byte), KeyModifiers::Alt, event);
+        case State::Csi:
+            if (byte == escape_byte) {
+                // Незавершённая последовательность прервана новым Esc
+                state_ = State::Escape;
+                started_ = time;
+                return false;
+            }
+            if (byte >= '0' && byte <= '9') {
+                if (param_count_ == 0) param_count_ = 1;
+                int& param = params_[param_count_ - 1];
+                if (param < 1000) param = param * 10 + (byte - '0');
+                return false;
+            }
+            if (byte == ';') {
+                if (param_count_ == 0) param_count_ = 1;
+                if (param_count_ < max_params) ++param_count_;
+                return false;
+            }
+            if (byte >= 0x40 && byte <= 0x7E) return finish_csi(byte, event);
+            // Промежуточные и приватные байты: такие последовательности не
+            // относятся к клавишам и пропускаются целиком
+            private_marker_ = true;
+            return false;
+        case State::Ss3:
+            return finish_ss3(byte, event);
+    }
+    return false;
+}
+
+bool InputDecoder::expire(Clock::time_point now, KeyEvent& event) {
+    if (state_ == State::Ground || now < deadline()) return false;
+    return finish(event);
+}
+
+bool InputDecoder::finish(KeyEvent& event) {
+    State state = state_;
+    state_ = State::Ground;
+    if (state != State::Escape) return false;
+    event = KeyEvent{KeyCode::Escape, KeyModifiers::None, started_};
+    return true;
+}
+
+bool InputDecoder::waiting() const { return state_ != State::Ground; }
+
+InputDecoder::Clock::time_point InputDecoder::deadline() const {
+    return started_ + escape_timeout;
+}
+
+bool InputDecoder::finish_csi(char final_byte, KeyEvent& event) {
+    state_ = State::Ground;
+    if (private_marker_) return false;
+    uint8_t modifiers =
+        param_count_ >= 2 ? modifiers_from_param(params_[1]) : 0;
+    if (final_byte == '~') {
+        int code = params_[0];
+        if (code <= 0 || code >= static_cast<int>(tilde_table.size()))
+            return false;
+        KeyCode key = tilde_table[code];
+        if (key == KeyCode{0}) return false;
+        return emit(key, modifiers, event);
+    }
+    KeyCode key = final_table[static_cast<unsigned char>(final_byte) & 0x7F];
+    if (key == KeyCode{0}) return false;
+    if (final_byte == 'Z') modifiers |= KeyModifiers::Shift;
+    return emit(key, modifiers, event);
+}
+
+bool InputDecoder::finish_ss3(char final_byte, KeyEvent& event) {
+    state_ = State::Ground;
+    KeyCode key = final_table[static_cast<unsigned char>(final_byte) & 0x7F];
+    if (key == KeyCode{0}) return false;
+    return emit(key, KeyModifiers::None, event);
+}
+
+bool InputDecoder::emit(KeyCode code, uint8_t modifiers, KeyEvent& event) {
+    event = KeyEvent{code, modifiers, started_};
+    return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "KeyEvent.h"
+
+// Потоковый разбор escape-последовательностей терминала (CSI и SS3).
+// Каждый байт даёт не больше одного события, память не выделяется.
+// Одиночный Esc нельзя отличить от начала последовательности, поэтому он
+// выдаётся только после escape_timeout без новых байтов
+class InputDecoder {
+  public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::chrono::milliseconds escape_timeout{30};
+
+    bool feed(char byte, Clock::time_point time, KeyEvent& event);
+    bool expire(Clock::time_point now, KeyEvent& event);
+    bool finish(KeyEvent& event);
+    bool waiting() const;
+    Clock::time_point deadline() const;
+
+  private:
+    enum class State : uint8_t { Ground, Escape, Csi, Ss3 };
+    static constexpr int max_params = 4;
+
+    bool finish_csi(char final_byte, KeyEvent& event);
+    bool finish_ss3(char final_byte, KeyEvent& event);
+    bool emit(KeyCode code, uint8_t modifiers, KeyEvent& event);
+
+    State state_ = State::Ground;
+    Clock::time_point started_;
+    std::array<int, max_params> params_{};
+    int param_count_ = 0;
+    bool private_marker_ = false;
+};
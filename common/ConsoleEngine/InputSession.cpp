@@ -0,0 +1,185 @@
+#include "InputSession.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <mutex>
+
+#include "TerminalSize.h"
+
+namespace {
+termios restore_termios;
+struct sigaction previous_actions[3];
+constexpr int restore_signals[3] = {SIGINT, SIGTERM, SIGQUIT};
+
+// Если игру прервали сигналом, деструктор не выполнится — возвращаем
+// терминал в исходный режим здесь
+void restore_terminal_on_signal(int signal) {
+    tcsetattr(STDIN_FILENO, TCSANOW, &restore_termios);
+    for (int i = 0; i < 3; ++i) {
+        if (restore_signals[i] == signal)
+            sigaction(signal, &previous_actions[i], nullptr);
+    }
+    raise(signal);
+}
+}  // namespace
+
+std::shared_ptr<InputSession> InputSession::acquire() {
+    static std::mutex mutex;
+    static std::weak_ptr<InputSession> current;
+    std::lock_guard lock(mutex);
+    auto session = current.lock();
+    if (!session) {
+        session = std::shared_ptr<InputSession>(new InputSession());
+        current = session;
+    }
+    return session;
+}
+
+InputSession::InputSession() {
+    if (tcgetattr(STDIN_FILENO, &saved_termios_) == 0) {
+        termios raw = saved_termios_;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        termios_changed_ = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+    }
+    if (termios_changed_) {
+        restore_termios = saved_termios_;
+        struct sigaction action {};
+        action.sa_handler = restore_terminal_on_signal;
+        sigemptyset(&action.sa_mask);
+        for (int i = 0; i < 3; ++i) {
+            sigaction(restore_signals[i], &action, &previous_actions[i]);
+        }
+    }
+    if (pipe(wake_pipe_) == 0) {
+        fcntl(wake_pipe_[0], F_SETFL, O_NONBLOCK);
+        fcntl(wake_pipe_[1], F_SETFL, O_NONBLOCK);
+    } else {
+        wake_pipe_[0] = wake_pipe_[1] = -1;
+    }
+    // Читающий конец блокирующий: байт гарантированно придёт, если флаг
+    // поднят, даже если писатель ещё не успел его записать
+    if (pipe(ready_pipe_) != 0) {
+        ready_pipe_[0] = ready_pipe_[1] = -1;
+    }
+    // Изменение размера терминала будит поток чтения, а тот — того, кто
+    // ждёт ввод: в ready_pipe_ пишет только signal_ready
+    TerminalSizeWatch::set_notify_fd(wake_pipe_[1]);
+    reader_ = std::thread(&InputSession::read_loop, this);
+}
+
+InputSession::~InputSession() {
+    TerminalSizeWatch::set_notify_fd(-1);
+    stopping_.store(true);
+    if (wake_pipe_[1] != -1) {
+        char c = 0;
+        [[maybe_unused]] auto written = write(wake_pipe_[1], &c, 1);
+    }
+    if (reader_.joinable()) reader_.join();
+    if (wake_pipe_[0] != -1) close(wake_pipe_[0]);
+    if (wake_pipe_[1] != -1) close(wake_pipe_[1]);
+    if (ready_pipe_[0] != -1) close(ready_pipe_[0]);
+    if (ready_pipe_[1] != -1) close(ready_pipe_[1]);
+    if (termios_changed_) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios_);
+        for (int i = 0; i < 3; ++i) {
+            sigaction(restore_signals[i], &previous_actions[i], nullptr);
+        }
+    }
+}
+
+std::optional<KeyEvent> InputSession::pop() {
+    if (auto event = queue_.try_pop()) return event;
+    // Очередь пуста: снимаем готовность и проверяем ещё раз, иначе событие,
+    // добавленное между проверкой и очисткой, осталось бы без сигнала.
+    // Пока готовность не поднята, опрос обходится без системных вызовов
+    if (!signaled_.load(std::memory_order_relaxed)) return std::nullopt;
+    clear_ready();
+    return queue_.try_pop();
+}
+
+int InputSession::ready_fd() const { return ready_pipe_[0]; }
+
+void InputSession::signal_ready() {
+    if (ready_pipe_[1] == -1) return;
+    if (signaled_.exchange(true, std::memory_order_acq_rel)) return;
+    char c = 0;
+    [[maybe_unused]] auto written = write(ready_pipe_[1], &c, 1);
+}
+
+void InputSession::clear_ready() {
+    if (ready_pipe_[0] == -1) return;
+    if (!signaled_.exchange(false, std::memory_order_acq_rel)) return;
+    char c;
+    while (read(ready_pipe_[0], &c, 1) < 0 && errno == EINTR) {
+    }
+}
+
+bool InputSession::push(const KeyEvent& event) {
+    // Нажатия не теряем: ждём, пока игра разберёт очередь
+    while (!queue_.try_push(event)) {
+        if (stopping_.load()) return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+void InputSession::read_loop() {
+    using namespace std::chrono;
+    pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {wake_pipe_[0], POLLIN, 0}};
+    char buffer[256];
+    KeyEvent event;
+    while (!stopping_.load()) {
+        bool has_pipe = wake_pipe_[0] != -1;
+        int timeout = has_pipe ? -1 : 100;
+        if (decoder_.waiting()) {
+            auto left = duration_cast<milliseconds>(decoder_.deadline() -
+                                                    steady_clock::now());
+            timeout = std::max<int>(0, static_cast<int>(left.count()) + 1);
+        }
+        int ready = poll(fds, has_pipe ? 2 : 1, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (ready == 0) {
+            if (decoder_.expire(steady_clock::now(), event)) {
+                if (!push(event)) return;
+                signal_ready();
+            }
+            continue;
+        }
+        if (has_pipe && (fds[1].revents & POLLIN)) {
+            if (stopping_.load()) return;
+            // Иначе это изменение размера терминала
+            while (read(wake_pipe_[0], buffer, sizeof(buffer)) > 0) {
+            }
+            signal_ready();
+            if (!(fds[0].revents & (POLLIN | POLLHUP))) continue;
+        }
+        if (!(fds[0].revents & (POLLIN | POLLHUP))) continue;
+
+        ssize_t count = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return;
+        // Вся пачка байтов (например, вставка из буфера обмена) разбирается
+        // за один проход
+        auto now = steady_clock::now();
+        bool pushed = false;
+        for (ssize_t i = 0; i < count; ++i) {
+            if (decoder_.feed(buffer[i], now, event)) {
+                if (!push(event)) return;
+                pushed = true;
+            }
+        }
+        if (pushed) signal_ready();
+    }
+}
+#endif
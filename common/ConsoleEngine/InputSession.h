@@ -0,0 +1,49 @@
+#pragma once
+#ifndef _WIN32
+#include <termios.h>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <thread>
+
+#include "InputDecoder.h"
+#include "KeyEvent.h"
+#include "SpscQueue.h"
+
+// Терминал переводится в неканонический режим один раз на всё время сессии,
+// а stdin читает отдельный поток
+class InputSession {
+  public:
+    static std::shared_ptr<InputSession> acquire();
+
+    InputSession(const InputSession&) = delete;
+    InputSession& operator=(const InputSession&) = delete;
+    ~InputSession();
+
+    std::optional<KeyEvent> pop();
+    // Дескриптор для poll: готов к чтению, пока в очереди есть события
+    int ready_fd() const;
+
+  private:
+    static constexpr size_t queue_capacity = 1024;
+
+    InputSession();
+    void read_loop();
+    bool push(const KeyEvent& event);
+    void signal_ready();
+    void clear_ready();
+
+    termios saved_termios_{};
+    bool termios_changed_ = false;
+    int wake_pipe_[2] = {-1, -1};
+    int ready_pipe_[2] = {-1, -1};
+    std::atomic<bool> stopping_{false};
+    // В ready_pipe_ лежит ровно один байт, пока флаг поднят: байт пишется
+    // только при переходе false→true и читается только при обратном
+    std::atomic<bool> signaled_{false};
+    InputDecoder decoder_;
+    SpscQueue<KeyEvent, queue_capacity> queue_;
+    std::thread reader_;
+};
+#endif
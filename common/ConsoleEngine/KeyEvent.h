@@ -0,0 +1,58 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+enum class KeyCode : uint16_t {
+    // Коды 0-255 — символ с тем же кодом
+    Tab = 9,
+    Enter = 13,
+    Escape = 27,
+    Backspace = 127,
+    Up = 256,
+    Down,
+    Right,
+    Left,
+    Home,
+    End,
+    Insert,
+    Delete,
+    PageUp,
+    PageDown,
+    F1,
+    F2,
+    F3,
+    F4,
+    F5,
+    F6,
+    F7,
+    F8,
+    F9,
+    F10,
+    F11,
+    F12,
+    Count,
+};
+
+constexpr size_t key_code_count = static_cast<size_t>(KeyCode::Count);
+
+namespace KeyModifiers {
+constexpr uint8_t None = 0;
+constexpr uint8_t Shift = 1;
+constexpr uint8_t Alt = 2;
+constexpr uint8_t Ctrl = 4;
+}  // namespace KeyModifiers
+
+struct KeyEvent {
+    KeyCode code = KeyCode{0};
+    uint8_t modifiers = KeyModifiers::None;
+    std::chrono::steady_clock::time_point timestamp;
+
+    static constexpr KeyCode from_char(char c) {
+        return static_cast<KeyCode>(static_cast<unsigned char>(c));
+    }
+    constexpr bool is_char() const { return static_cast<uint16_t>(code) < 256; }
+    constexpr char get_char() const {
+        return is_char() ? static_cast<char>(code) : '\0';
+    }
+};
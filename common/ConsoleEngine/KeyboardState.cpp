@@ -0,0 +1,79 @@
+#include "KeyboardState.h"
+
+#include <cctype>
+#include <limits>
+
+int KeySnapshot::press_count(KeyCode key) const {
+    return presses[KeyboardState::key_index(key)];
+}
+bool KeySnapshot::pressed(KeyCode key) const { return press_count(key) > 0; }
+bool KeySnapshot::is_held(KeyCode key) const {
+    return held[KeyboardState::key_index(key)];
+}
+bool KeySnapshot::is_down(KeyCode key) const {
+    return pressed(key) || is_held(key);
+}
+int KeySnapshot::press_count(char key) const {
+    return press_count(KeyEvent::from_char(key));
+}
+bool KeySnapshot::pressed(char key) const {
+    return pressed(KeyEvent::from_char(key));
+}
+bool KeySnapshot::is_held(char key) const {
+    return is_held(KeyEvent::from_char(key));
+}
+bool KeySnapshot::is_down(char key) const {
+    return is_down(KeyEvent::from_char(key));
+}
+
+size_t KeyboardState::key_index(KeyCode key) {
+    size_t index = static_cast<size_t>(key);
+    // Буквы не различаются по регистру, как коды клавиш в GetAsyncKeyState
+    if (index < 256) return static_cast<size_t>(std::toupper(int(index)));
+    return index < key_code_count ? index : 0;
+}
+size_t KeyboardState::key_index(char key) {
+    return key_index(KeyEvent::from_char(key));
+}
+
+// Нажатия копятся, пока игра их не заберёт, но автоповтор уже удерживаемой
+// клавиши оставляет не больше одного: иначе за время удержания набралась
+// бы очередь, и после отпускания клавиша ещё долго читалась бы нажатой
+void KeyboardState::record(const KeyEvent& event) {
+    size_t index = key_index(event.code);
+    bool auto_repeat = is_held(event.code, event.timestamp);
+    repeating_[index] = last_seen_[index] != Clock::time_point{} &&
+                        event.timestamp - last_seen_[index] < repeat_delay;
+    last_seen_[index] = event.timestamp;
+    if (!(auto_repeat && unconsumed_[index] > 0) &&
+        unconsumed_[index] < std::numeric_limits<uint16_t>::max())
+        ++unconsumed_[index];
+    if (frame_presses_[index] < std::numeric_limits<uint16_t>::max())
+        ++frame_presses_[index];
+}
+
+bool KeyboardState::consume_press(KeyCode key) {
+    size_t index = key_index(key);
+    if (unconsumed_[index] == 0) return false;
+    --unconsumed_[index];
+    return true;
+}
+
+bool KeyboardState::is_held(KeyCode key, Clock::time_point now) const {
+    size_t index = key_index(key);
+    return repeating_[index] && now - last_seen_[index] < release_timeout;
+}
+
+KeyboardState::Clock::time_point KeyboardState::last_seen(KeyCode key) const {
+    return last_seen_[key_index(key)];
+}
+
+KeySnapshot KeyboardState::snapshot(Clock::time_point now) {
+    KeySnapshot result;
+    result.presses = frame_presses_;
+    for (size_t i = 0; i < key_code_count; ++i) {
+        result.held[i] = repeating_[i] && now - last_seen_[i] < release_timeout;
+    }
+    frame_presses_.fill(0);
+    return result;
+}
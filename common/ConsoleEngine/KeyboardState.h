@@ -0,0 +1,47 @@
+#pragma once
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+
+#include "KeyEvent.h"
+
+// Терминал не сообщает об отпускании клавиш, поэтому удержание
+// определяется по автоповтору: повторы приходят чаще, чем repeat_delay,
+// и прекращаются после отпускания
+struct KeySnapshot {
+    std::array<uint16_t, key_code_count> presses{};
+    std::bitset<key_code_count> held;
+
+    int press_count(KeyCode key) const;
+    bool pressed(KeyCode key) const;
+    bool is_held(KeyCode key) const;
+    bool is_down(KeyCode key) const;
+    int press_count(char key) const;
+    bool pressed(char key) const;
+    bool is_held(char key) const;
+    bool is_down(char key) const;
+};
+
+class KeyboardState {
+  public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::chrono::milliseconds repeat_delay{600};
+    static constexpr std::chrono::milliseconds release_timeout{120};
+
+    static size_t key_index(KeyCode key);
+    static size_t key_index(char key);
+
+    void record(const KeyEvent& event);
+    // Забирает одно нажатие из накопленных: два быстрых нажатия — два true
+    bool consume_press(KeyCode key);
+    bool is_held(KeyCode key, Clock::time_point now) const;
+    Clock::time_point last_seen(KeyCode key) const;
+    KeySnapshot snapshot(Clock::time_point now);
+
+  private:
+    std::array<Clock::time_point, key_code_count> last_seen_{};
+    std::array<bool, key_code_count> repeating_{};
+    std::array<uint16_t, key_code_count> unconsumed_{};
+    std::array<uint16_t, key_code_count> frame_presses_{};
+};
@@ -0,0 +1,66 @@
+#include "OutputBacklog.h"
+
+#ifndef _WIN32
+#include <sys/ioctl.h>
+#endif
+
+OutputBacklog::OutputBacklog(Probe probe) : probe_(std::move(probe)) {}
+
+#ifdef _WIN32
+OutputBacklog OutputBacklog::for_fd(int) { return OutputBacklog(); }
+#else
+OutputBacklog OutputBacklog::for_fd(int fd) {
+    int queued = 0;
+    if (ioctl(fd, TIOCOUTQ, &queued) != 0) return OutputBacklog();
+    return OutputBacklog([fd] {
+        int queued = 0;
+        if (ioctl(fd, TIOCOUTQ, &queued) != 0 || queued < 0) return size_t{0};
+        return static_cast<size_t>(queued);
+    });
+}
+#endif
+
+void OutputBacklog::before_write(Clock::time_point now) {
+    if (queued_after_write_ == 0) return;
+    size_t queued = get_queued();
+    // Очередь не опустела с прошлой записи: всё это время терминал забирал
+    // вывод так быстро, как мог, и убыль очереди — его скорость
+    if (queued == 0 || queued >= queued_after_write_) return;
+    auto elapsed = std::chrono::duration<double>(now - last_write_).count();
+    if (elapsed > 0.0)
+        add_rate_sample((queued_after_write_ - queued) / elapsed);
+}
+
+void OutputBacklog::after_write(size_t bytes, Clock::time_point started,
+                                Clock::time_point finished) {
+    // write блокируется, только когда очередь полна: он ждал, пока терминал
+    // заберёт записанное
+    constexpr auto blocked = std::chrono::milliseconds(1);
+    if (probe_ && bytes > 0 && finished - started >= blocked) {
+        add_rate_sample(bytes /
+                        std::chrono::duration<double>(finished - started).count());
+    }
+    queued_after_write_ = get_queued();
+    last_write_ = finished;
+}
+
+size_t OutputBacklog::get_queued() const { return probe_ ? probe_() : 0; }
+
+double OutputBacklog::get_drain_rate() const { return drain_rate_; }
+
+OutputBacklog::Clock::duration OutputBacklog::estimate_delay() const {
+    if (drain_rate_ <= 0.0) return Clock::duration::zero();
+    size_t queued = get_queued();
+    if (queued == 0) return Clock::duration::zero();
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(queued / drain_rate_));
+}
+
+// Скорость терминала меняется (например, вместе с сетью), поэтому оценка
+// сглаживается, но быстро следует за новыми замерами
+void OutputBacklog::add_rate_sample(double bytes_per_second) {
+    constexpr double weight = 0.3;
+    drain_rate_ = drain_rate_ == 0.0
+                      ? bytes_per_second
+                      : drain_rate_ + weight * (bytes_per_second - drain_rate_);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <functional>
+
+// Оценка того, насколько терминал отстаёт от вывода. Размер очереди tty
+// берётся ioctl(TIOCOUTQ), скорость, с которой терминал её разбирает, —
+// из того, как очередь убывает между записями и сколько блокируется write.
+// Без очереди (не терминал, Windows) задержка всегда нулевая
+class OutputBacklog {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Probe = std::function<size_t()>;
+
+    OutputBacklog() = default;
+    explicit OutputBacklog(Probe probe);
+    // Очередь вывода терминала на дескрипторе fd
+    static OutputBacklog for_fd(int fd);
+
+    void before_write(Clock::time_point now);
+    void after_write(size_t bytes, Clock::time_point started,
+                     Clock::time_point finished);
+
+    size_t get_queued() const;
+    // Байтов в секунду; 0 — терминал ещё ни разу не отставал
+    double get_drain_rate() const;
+    // Через сколько терминал покажет то, что записано сейчас
+    Clock::duration estimate_delay() const;
+
+  private:
+    void add_rate_sample(double bytes_per_second);
+
+    Probe probe_;
+    double drain_rate_ = 0.0;
+    size_t queued_after_write_ = 0;
+    Clock::time_point last_write_;
+};
@@ -0,0 +1,190 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <version>
+
+#if __has_include(<format>)
+#include <format>
+#endif
+
+// Вывод по строке формата, заданной параметром шаблона: формат проверяется
+// при компиляции, текст дописывается в конец буфера, и при достаточной
+// ёмкости буфера ничего не выделяется. Если стандартная библиотека
+// поддерживает <format>, работает std::format_to; иначе — своя реализация
+// подмножества: {} и {:[[заполнитель]выравнивание][ширина]}, где ширина —
+// число или {} (следующий аргумент)
+namespace PrintFormat {
+
+template <size_t N>
+struct FixedString {
+    char data[N]{};
+    constexpr FixedString(const char (&text)[N]) {
+        std::copy_n(text, N, data);
+    }
+    constexpr std::string_view view() const { return {data, N - 1}; }
+};
+
+#ifdef __cpp_lib_format
+template <FixedString Format, typename... Args>
+void format_to(std::string& out, Args&&... args) {
+    std::format_to(std::back_inserter(out),
+                   std::format_string<Args...>(Format.view()),
+                   std::forward<Args>(args)...);
+}
+#else
+struct Spec {
+    char fill = ' ';
+    char align = '\0';
+    size_t width = 0;
+    bool dynamic_width = false;
+};
+
+// Разбирает поле, начиная сразу за '{'. Возвращает позицию закрывающей
+// '}' или npos, если поле не входит в поддерживаемое подмножество
+constexpr size_t parse_spec(std::string_view format, size_t pos, Spec& spec) {
+    auto is_align = [](char c) { return c == '<' || c == '>' || c == '^'; };
+    if (pos < format.size() && format[pos] == '}') return pos;
+    if (pos >= format.size() || format[pos] != ':') return std::string_view::npos;
+    ++pos;
+    if (pos + 1 < format.size() && is_align(format[pos + 1]) &&
+        format[pos] != '{' && format[pos] != '}') {
+        spec.fill = format[pos];
+        spec.align = format[pos + 1];
+        pos += 2;
+    } else if (pos < format.size() && is_align(format[pos])) {
+        spec.align = format[pos++];
+    }
+    if (format.substr(pos, 2) == "{}") {
+        spec.dynamic_width = true;
+        pos += 2;
+    } else {
+        while (pos < format.size() && format[pos] >= '0' && format[pos] <= '9') {
+            spec.width = spec.width * 10 + (format[pos++] - '0');
+        }
+    }
+    if (pos >= format.size() || format[pos] != '}') return std::string_view::npos;
+    return pos;
+}
+
+// Сколько аргументов требует формат; -1 — формат некорректен
+constexpr int count_args(std::string_view format) {
+    int count = 0;
+    for (size_t i = 0; i < format.size(); ++i) {
+        if (format[i] == '}') {
+            if (i + 1 >= format.size() || format[i + 1] != '}') return -1;
+            ++i;
+        } else if (format[i] == '{') {
+            if (i + 1 < format.size() && format[i + 1] == '{') {
+                ++i;
+                continue;
+            }
+            Spec spec;
+            size_t end = parse_spec(format, i + 1, spec);
+            if (end == std::string_view::npos) return -1;
+            count += spec.dynamic_width ? 2 : 1;
+            i = end;
+        }
+    }
+    return count;
+}
+
+template <typename T>
+void append_value(std::string& out, const T& value) {
+    if constexpr (std::is_same_v<T, char>) {
+        out.push_back(value);
+    } else if constexpr (std::is_same_v<T, bool>) {
+        out.append(value ? "true" : "false");
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        char digits[32];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, result.ptr);
+    } else {
+        static_assert(std::is_convertible_v<const T&, std::string_view>,
+                      "type is not supported without <format>");
+        out.append(std::string_view(value));
+    }
+}
+
+// Аргумент без типа: так разбор формата не размножается по наборам типов
+struct Arg {
+    const void* value;
+    void (*append)(std::string& out, const void* value);
+    size_t (*to_width)(const void* value);
+    // Как в std::format: числа по умолчанию прижимаются вправо
+    char default_align;
+};
+
+template <typename T>
+Arg make_arg(const T& value) {
+    return Arg{
+        &value,
+        [](std::string& out, const void* value) {
+            append_value(out, *static_cast<const T*>(value));
+        },
+        [](const void* value) -> size_t {
+            if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+                return std::max<T>(*static_cast<const T*>(value), 0);
+            } else {
+                return 0;
+            }
+        },
+        std::is_arithmetic_v<T> && !std::is_same_v<T, char> &&
+                !std::is_same_v<T, bool>
+            ? '>'
+            : '<'};
+}
+
+// Формат уже проверен count_args
+inline void vformat_to(std::string& out, std::string_view format,
+                       const Arg* args) {
+    size_t next = 0;
+    for (size_t i = 0; i < format.size(); ++i) {
+        char c = format[i];
+        if (c == '}' || (c == '{' && format[i + 1] == '{')) {
+            out.push_back(c);
+            ++i;
+            continue;
+        }
+        if (c != '{') {
+            out.push_back(c);
+            continue;
+        }
+        Spec spec;
+        i = parse_spec(format, i + 1, spec);
+        const Arg& arg = args[next++];
+        size_t width = spec.width;
+        if (spec.dynamic_width) {
+            width = args[next].to_width(args[next].value);
+            ++next;
+        }
+        size_t start = out.size();
+        arg.append(out, arg.value);
+        size_t length = out.size() - start;
+        if (width <= length) continue;
+        // Ширина считается в байтах: в играх выводится только ASCII
+        size_t padding = width - length;
+        char align = spec.align ? spec.align : arg.default_align;
+        size_t before = align == '>' ? padding : align == '^' ? padding / 2 : 0;
+        out.insert(start, before, spec.fill);
+        out.append(padding - before, spec.fill);
+    }
+}
+
+template <FixedString Format, typename... Args>
+void format_to(std::string& out, const Args&... args) {
+    constexpr int count = count_args(Format.view());
+    static_assert(count >= 0, "invalid or unsupported format string");
+    static_assert(count == sizeof...(Args),
+                  "format string does not match the arguments");
+    const std::array<Arg, sizeof...(Args)> packed{make_arg(args)...};
+    vformat_to(out, Format.view(), packed.data());
+}
+#endif
+
+}  // namespace PrintFormat
@@ -0,0 +1,102 @@
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+RenderStats::RenderStats(const RenderStats&) {}
+
+RenderStats& RenderStats::operator=(const RenderStats&) {
+    options_ = RenderStatsOptions{};
+    current_ = FrameStats{};
+    formatting_ = false;
+    history_.clear();
+    frame_count_ = 0;
+    return *this;
+}
+
+RenderStats::~RenderStats() {
+    if (options_.csv_path.empty() || history_.empty()) return;
+    std::ofstream file(options_.csv_path, std::ios::trunc);
+    write_csv(file);
+}
+
+void RenderStats::set_options(RenderStatsOptions options) {
+    options_ = std::move(options);
+}
+const RenderStatsOptions& RenderStats::get_options() const { return options_; }
+
+void RenderStats::begin_frame() {
+    frame_started_ = Clock::now();
+    formatting_ = true;
+}
+
+void RenderStats::record_write(std::string_view data, bool flushed,
+                               Clock::time_point started,
+                               Clock::time_point finished) {
+    // Первая запись кадра завершает его сборку
+    if (formatting_) {
+        current_.format_time += started - frame_started_;
+        formatting_ = false;
+    }
+    current_.bytes += data.size();
+    current_.sequences += std::count(data.begin(), data.end(), '\033');
+    if (flushed) ++current_.flushes;
+    current_.write_time += finished - started;
+}
+
+void RenderStats::add_cells_changed(uint32_t cells) {
+    current_.cells_changed += cells;
+}
+
+void RenderStats::end_frame() {
+    if (formatting_) {
+        current_.format_time += Clock::now() - frame_started_;
+        formatting_ = false;
+    }
+    // Без CSV история никому не нужна: хранится только последний кадр, и
+    // статистика не выделяет память на каждом кадре
+    if (options_.csv_path.empty() && !history_.empty()) {
+        history_.back() = current_;
+    } else {
+        history_.push_back(current_);
+    }
+    ++frame_count_;
+    current_ = FrameStats{};
+}
+
+const FrameStats& RenderStats::get_last() const {
+    static const FrameStats empty;
+    return history_.empty() ? empty : history_.back();
+}
+
+const std::vector<FrameStats>& RenderStats::get_history() const {
+    return history_;
+}
+
+std::string RenderStats::format_overlay() const {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    const FrameStats& last = get_last();
+    std::ostringstream out;
+    out << "frame " << frame_count_ << " | " << last.bytes << " B | "
+        << last.sequences << " seq | " << last.cells_changed << " cells | "
+        << last.flushes << " flush | fmt "
+        << duration_cast<microseconds>(last.format_time).count()
+        << " us | write "
+        << duration_cast<microseconds>(last.write_time).count() << " us";
+    return out.str();
+}
+
+void RenderStats::write_csv(std::ostream& out) const {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    out << "frame,bytes,sequences,cells_changed,flushes,format_us,write_us\n";
+    for (size_t i = 0; i < history_.size(); ++i) {
+        const FrameStats& frame = history_[i];
+        out << i + 1 << ',' << frame.bytes << ',' << frame.sequences << ','
+            << frame.cells_changed << ',' << frame.flushes << ','
+            << duration_cast<microseconds>(frame.format_time).count() << ','
+            << duration_cast<microseconds>(frame.write_time).count() << '\n';
+    }
+}
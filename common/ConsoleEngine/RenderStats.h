@@ -0,0 +1,60 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Стоимость одного кадра: кадр закрывается внешним end_frame, вывод вне
+// кадров относится к следующему кадру
+struct FrameStats {
+    uint64_t bytes = 0;
+    uint32_t sequences = 0;
+    uint32_t cells_changed = 0;
+    uint32_t flushes = 0;
+    std::chrono::nanoseconds format_time{0};
+    std::chrono::nanoseconds write_time{0};
+};
+
+struct RenderStatsOptions {
+    // Строка со статистикой предыдущего кадра под кадровым буфером
+    bool overlay = false;
+    // Куда записать статистику всех кадров в CSV при уничтожении движка
+    std::string csv_path;
+};
+
+// Статистика принадлежит движку: копия движка начинает с пустой истории
+// и не пишет CSV
+class RenderStats {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    RenderStats() = default;
+    RenderStats(const RenderStats& other);
+    RenderStats& operator=(const RenderStats& other);
+    ~RenderStats();
+
+    void set_options(RenderStatsOptions options);
+    const RenderStatsOptions& get_options() const;
+
+    void begin_frame();
+    void record_write(std::string_view data, bool flushed,
+                      Clock::time_point started, Clock::time_point finished);
+    void add_cells_changed(uint32_t cells);
+    void end_frame();
+
+    const FrameStats& get_last() const;
+    // Все кадры, если задан csv_path; иначе только последний
+    const std::vector<FrameStats>& get_history() const;
+    std::string format_overlay() const;
+    void write_csv(std::ostream& out) const;
+
+  private:
+    RenderStatsOptions options_;
+    FrameStats current_;
+    Clock::time_point frame_started_;
+    bool formatting_ = false;
+    std::vector<FrameStats> history_;
+    uint64_t frame_count_ = 0;
+};
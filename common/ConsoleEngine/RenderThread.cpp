@@ -0,0 +1,96 @@
+#include "RenderThread.h"
+
+void FrameParams::absorb(const FrameParams& dropped) {
+    erase_margins = erase_margins || dropped.erase_margins;
+    if (!dropped.scroll_hint) return;
+    // Front-буфер потока ещё не видел сдвиг пропущенного кадра: сдвиги одной
+    // области складываются. Подсказка для другой области только уточняет
+    // оценку, поэтому остаётся более новая
+    if (!scroll_hint) {
+        scroll_hint = dropped.scroll_hint;
+    } else if (scroll_hint->top == dropped.scroll_hint->top &&
+               scroll_hint->bottom == dropped.scroll_hint->bottom) {
+        scroll_hint->lines += dropped.scroll_hint->lines;
+    }
+}
+
+RenderThread::RenderThread(const RenderThread&) {}
+
+RenderThread& RenderThread::operator=(const RenderThread& other) {
+    if (this != &other) stop();
+    return *this;
+}
+
+RenderThread::~RenderThread() { stop(); }
+
+void RenderThread::start(RenderFunction render, DelayFunction delay) {
+    if (is_running()) return;
+    render_ = std::move(render);
+    delay_ = std::move(delay);
+    stopping_ = false;
+    thread_ = std::thread(&RenderThread::run, this);
+}
+
+void RenderThread::stop() {
+    if (!is_running()) return;
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+bool RenderThread::is_running() const { return thread_.joinable(); }
+
+FrameSnapshot& RenderThread::next_frame() { return frames_.write_slot(); }
+
+void RenderThread::publish() {
+    {
+        std::lock_guard lock(mutex_);
+        // Поток забирает кадр только под блокировкой, поэтому свежий кадр
+        // можно прочитать: он будет заменён этим и не выйдет в терминал
+        if (frames_.has_fresh()) {
+            frames_.write_slot().params.absorb(frames_.ready_slot().params);
+            ++dropped_frames_;
+        }
+        frames_.publish();
+    }
+    wake_.notify_one();
+}
+
+void RenderThread::wait_idle() const {
+    if (!is_running()) return;
+    std::unique_lock lock(mutex_);
+    idle_.wait(lock, [&] { return !busy_ && !frames_.has_fresh(); });
+}
+
+uint64_t RenderThread::get_dropped_frames() const {
+    std::lock_guard lock(mutex_);
+    return dropped_frames_;
+}
+
+void RenderThread::run() {
+    std::unique_lock lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [&] { return stopping_ || frames_.has_fresh(); });
+        // Пока терминал разбирает прежний вывод, новые кадры заменяют друг
+        // друга в буфере, а не встают в очередь tty
+        if (!stopping_ && delay_) {
+            auto delay = delay_();
+            if (delay > std::chrono::nanoseconds::zero()) {
+                wake_.wait_for(lock, delay, [&] { return stopping_; });
+                continue;
+            }
+        }
+        // Перед остановкой последний опубликованный кадр всё же выводится
+        const FrameSnapshot* frame = frames_.take();
+        if (!frame) return;
+        busy_ = true;
+        lock.unlock();
+        render_(*frame);
+        lock.lock();
+        busy_ = false;
+        idle_.notify_all();
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "FrameBuffer.h"
+#include "TerminalSize.h"
+#include "TripleBuffer.h"
+
+// Сдвиг строк top..bottom на lines, подсказанный игрой
+struct ScrollHint {
+    int top;
+    int bottom;
+    int lines;
+};
+
+// Всё, что нужно для вывода кадра, кроме самих клеток
+struct FrameParams {
+    ClipRect clip;
+    std::optional<TerminalSize> terminal_size;
+    std::optional<ScrollHint> scroll_hint;
+    bool erase_margins = false;
+
+    // Кадр, который так и не вывели, заменяется этим: его подсказки не
+    // должны потеряться
+    void absorb(const FrameParams& dropped);
+};
+
+// Неизменяемый снимок кадра: игра заполняет его и больше не трогает
+struct FrameSnapshot {
+    FrameBuffer cells;
+    FrameParams params;
+};
+
+// Поток вывода кадров. Игра публикует снимок и сразу продолжает, поток
+// отправляет в терминал самый свежий готовый снимок. Снимки лежат в тройном
+// буфере, поэтому публикация не ждёт вывода, а при медленном терминале
+// промежуточные кадры пропускаются. Копия объекта начинает без потока
+class RenderThread {
+  public:
+    using RenderFunction = std::function<void(const FrameSnapshot&)>;
+    // Сколько ещё подождать перед выводом следующего кадра
+    using DelayFunction = std::function<std::chrono::nanoseconds()>;
+
+    RenderThread() = default;
+    RenderThread(const RenderThread& other);
+    RenderThread& operator=(const RenderThread& other);
+    ~RenderThread();
+
+    void start(RenderFunction render, DelayFunction delay = nullptr);
+    // Выводит уже опубликованный кадр и останавливает поток
+    void stop();
+    bool is_running() const;
+
+    // Снимок для следующего кадра: принадлежит игре до publish
+    FrameSnapshot& next_frame();
+    void publish();
+    // Ждёт, пока опубликованный кадр будет выведен и поток освободится.
+    // После этого до следующего publish поток не трогает движок
+    void wait_idle() const;
+    uint64_t get_dropped_frames() const;
+
+  private:
+    void run();
+
+    TripleBuffer<FrameSnapshot> frames_;
+    RenderFunction render_;
+    DelayFunction delay_;
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    mutable std::condition_variable idle_;
+    bool busy_ = false;
+    bool stopping_ = false;
+    uint64_t dropped_frames_ = 0;
+};
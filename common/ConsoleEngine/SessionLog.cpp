@@ -0,0 +1,170 @@
+#include "SessionLog.h"
+
+namespace {
+void append_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// Разбор varint из уже прочитанных данных записи
+std::optional<uint64_t> parse_varint(std::string_view& data) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64 && !data.empty(); shift += 7) {
+        auto byte = static_cast<uint8_t>(data.front());
+        data.remove_prefix(1);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    return std::nullopt;
+}
+}  // namespace
+
+SessionRecorder::SessionRecorder(const SessionRecorder&) {}
+
+SessionRecorder& SessionRecorder::operator=(const SessionRecorder& other) {
+    if (this != &other) close();
+    return *this;
+}
+
+bool SessionRecorder::open(const std::string& path) {
+    close();
+    std::lock_guard lock(mutex_);
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_) return false;
+    file_.write(SessionReader::magic.data(), SessionReader::magic.size());
+    last_ = last_flush_ = Clock::now();
+    return true;
+}
+
+void SessionRecorder::close() {
+    std::lock_guard lock(mutex_);
+    if (file_.is_open()) file_.close();
+}
+
+bool SessionRecorder::is_open() const {
+    std::lock_guard lock(mutex_);
+    return file_.is_open();
+}
+
+void SessionRecorder::record_output(std::string_view data, bool flushed) {
+    std::lock_guard lock(mutex_);
+    if (!file_.is_open()) return;
+    if (!data.empty()) write_record(SessionEvent::Type::Output, data);
+    if (!flushed) return;
+    write_record(SessionEvent::Type::Flush, {});
+    // Если игру завершит сигнал, в журнале останется почти весь сеанс, а
+    // лишний write на каждый кадр не исказит записываемую нагрузку
+    constexpr auto flush_period = std::chrono::milliseconds(250);
+    if (last_ - last_flush_ >= flush_period) {
+        file_.flush();
+        last_flush_ = last_;
+    }
+}
+
+void SessionRecorder::record_key(const KeyEvent& key) {
+    std::lock_guard lock(mutex_);
+    if (!file_.is_open()) return;
+    payload_.clear();
+    append_varint(payload_, static_cast<uint16_t>(key.code));
+    payload_.push_back(static_cast<char>(key.modifiers));
+    write_record(SessionEvent::Type::Key, payload_);
+}
+
+void SessionRecorder::record_line(std::string_view line) {
+    std::lock_guard lock(mutex_);
+    if (!file_.is_open()) return;
+    write_record(SessionEvent::Type::Line, line);
+}
+
+void SessionRecorder::record_resize(TerminalSize size) {
+    std::lock_guard lock(mutex_);
+    if (!file_.is_open()) return;
+    payload_.clear();
+    append_varint(payload_, static_cast<uint32_t>(size.width));
+    append_varint(payload_, static_cast<uint32_t>(size.height));
+    write_record(SessionEvent::Type::Resize, payload_);
+}
+
+// Время пишется от прошлой записи: в кадре игры это один-два байта
+void SessionRecorder::write_record(SessionEvent::Type type,
+                                   std::string_view payload) {
+    auto now = Clock::now();
+    auto elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(now - last_);
+    // Накопленный остаток меньше микросекунды переходит к следующей записи
+    last_ += elapsed;
+    record_.clear();
+    record_.push_back(static_cast<char>(type));
+    append_varint(record_, elapsed.count());
+    append_varint(record_, payload.size());
+    file_.write(record_.data(), record_.size());
+    file_.write(payload.data(), payload.size());
+}
+
+bool SessionReader::open(const std::string& path) {
+    file_.open(path, std::ios::binary | std::ios::ate);
+    file_size_ = file_.tellg();
+    file_.seekg(0);
+    std::string header(magic.size(), '\0');
+    if (!file_.read(header.data(), header.size())) return false;
+    time_ = std::chrono::microseconds{0};
+    return header == magic;
+}
+
+std::optional<uint64_t> SessionReader::read_varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = file_.get();
+        if (byte == std::ifstream::traits_type::eof()) return std::nullopt;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    return std::nullopt;
+}
+
+std::optional<SessionEvent> SessionReader::next() {
+    int type = file_.get();
+    if (type == std::ifstream::traits_type::eof()) return std::nullopt;
+    auto elapsed = read_varint();
+    auto length = read_varint();
+    if (!elapsed || !length) return std::nullopt;
+    // Повреждённая длина не должна превращаться в огромное выделение памяти
+    std::streamoff left = file_size_ - file_.tellg();
+    if (*length > static_cast<uint64_t>(left)) return std::nullopt;
+
+    SessionEvent event;
+    event.type = static_cast<SessionEvent::Type>(type);
+    time_ += std::chrono::microseconds(*elapsed);
+    event.time = time_;
+    event.data.resize(*length);
+    if (!file_.read(event.data.data(), *length)) return std::nullopt;
+
+    std::string_view payload = event.data;
+    switch (event.type) {
+        case SessionEvent::Type::Output:
+        case SessionEvent::Type::Flush:
+        case SessionEvent::Type::Line:
+            return event;
+        case SessionEvent::Type::Key: {
+            auto code = parse_varint(payload);
+            if (!code || payload.size() != 1) return std::nullopt;
+            event.key.code = static_cast<KeyCode>(*code);
+            event.key.modifiers = static_cast<uint8_t>(payload.front());
+            event.data.clear();
+            return event;
+        }
+        case SessionEvent::Type::Resize: {
+            auto width = parse_varint(payload);
+            auto height = parse_varint(payload);
+            if (!width || !height) return std::nullopt;
+            event.size = TerminalSize{static_cast<int>(*width),
+                                      static_cast<int>(*height)};
+            event.data.clear();
+            return event;
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "KeyEvent.h"
+#include "TerminalSize.h"
+
+// Журнал сеанса: всё, что движок отправил в терминал, и весь полученный
+// ввод с метками времени. После заголовка "CESLOG1\n" идут записи
+// <тип: байт><мкс от прошлой записи: varint><длина: varint><данные>.
+// Вывод хранится как есть, клавиша — varint кода и байт модификаторов,
+// строка get() — её текст, размер экрана — varint ширины и высоты
+struct SessionEvent {
+    enum class Type : uint8_t {
+        Output = 1,
+        // Сброс потока: для HeadlessTerminal конец кадра
+        Flush = 2,
+        Key = 3,
+        Line = 4,
+        Resize = 5,
+    };
+    Type type = Type::Output;
+    // От начала записи
+    std::chrono::microseconds time{0};
+    // Output и Line
+    std::string data;
+    KeyEvent key;
+    TerminalSize size;
+};
+
+// Пишет журнал; вывод может приходить из потока вывода, ввод — из потока
+// игры. Копия начинает без файла
+class SessionRecorder {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    SessionRecorder() = default;
+    SessionRecorder(const SessionRecorder& other);
+    SessionRecorder& operator=(const SessionRecorder& other);
+
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const;
+
+    void record_output(std::string_view data, bool flushed);
+    void record_key(const KeyEvent& key);
+    void record_line(std::string_view line);
+    void record_resize(TerminalSize size);
+
+  private:
+    void write_record(SessionEvent::Type type, std::string_view payload);
+
+    std::ofstream file_;
+    Clock::time_point last_;
+    Clock::time_point last_flush_;
+    // Заголовок записи и мелкие данные; ёмкость переиспользуется
+    std::string record_;
+    std::string payload_;
+    mutable std::mutex mutex_;
+};
+
+class SessionReader {
+  public:
+    static constexpr std::string_view magic = "CESLOG1\n";
+
+    bool open(const std::string& path);
+    // nullopt — конец журнала или повреждённая запись
+    std::optional<SessionEvent> next();
+
+  private:
+    std::optional<uint64_t> read_varint();
+
+    std::ifstream file_;
+    // Длина записи проверяется по остатку файла до выделения памяти
+    std::streamoff file_size_ = 0;
+    std::chrono::microseconds time_{0};
+};
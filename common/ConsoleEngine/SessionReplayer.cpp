@@ -0,0 +1,55 @@
+#include "SessionReplayer.h"
+
+#include <thread>
+
+bool SessionReplayer::open(const std::string& path) {
+    if (!reader_.open(path)) return false;
+    pending_ = reader_.next();
+    TerminalSize size = default_size;
+    if (pending_ && pending_->type == SessionEvent::Type::Resize) {
+        size = pending_->size;
+        pending_.reset();
+    }
+    terminal_ = std::make_unique<HeadlessTerminal>(size.width, size.height);
+    return true;
+}
+
+SessionReplayer::Result SessionReplayer::play(Pace pace) {
+    using Clock = std::chrono::steady_clock;
+    Result result;
+    std::ostream& out = terminal_->stream();
+    auto next = [&] {
+        std::optional<SessionEvent> event = std::move(pending_);
+        pending_.reset();
+        return event ? std::move(event) : reader_.next();
+    };
+    auto started = Clock::now();
+    while (auto event = next()) {
+        if (pace == Pace::Recorded)
+            std::this_thread::sleep_until(started + event->time);
+        result.recorded_time = event->time;
+        switch (event->type) {
+            case SessionEvent::Type::Output:
+                out.write(event->data.data(), event->data.size());
+                ++result.outputs;
+                break;
+            case SessionEvent::Type::Flush:
+                out.flush();
+                break;
+            case SessionEvent::Type::Key:
+                ++result.keys;
+                break;
+            case SessionEvent::Type::Line:
+                ++result.lines;
+                break;
+            case SessionEvent::Type::Resize:
+                terminal_->resize(event->size.width, event->size.height);
+                ++result.resizes;
+                break;
+        }
+    }
+    result.replay_time = Clock::now() - started;
+    return result;
+}
+
+HeadlessTerminal& SessionReplayer::get_terminal() { return *terminal_; }
@@ -0,0 +1,42 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "HeadlessTerminal.h"
+#include "SessionLog.h"
+
+// Проигрывает журнал сеанса на HeadlessTerminal: вывод уходит в терминал
+// теми же порциями и с теми же сбросами, что и при записи, так что
+// счётчики терминала сравнимы между сборками. Ввод только подсчитывается
+class SessionReplayer {
+  public:
+    enum class Pace {
+        // С паузами между записями, как при записи
+        Recorded,
+        // Без пауз
+        Max,
+    };
+    struct Result {
+        uint64_t outputs = 0;
+        uint64_t keys = 0;
+        uint64_t lines = 0;
+        uint64_t resizes = 0;
+        std::chrono::microseconds recorded_time{0};
+        std::chrono::nanoseconds replay_time{0};
+    };
+    // Размер терминала до первой записи о размере
+    static constexpr TerminalSize default_size{80, 24};
+
+    // Терминал создаётся по размеру из начала журнала
+    bool open(const std::string& path);
+    Result play(Pace pace);
+    HeadlessTerminal& get_terminal();
+
+  private:
+    SessionReader reader_;
+    std::unique_ptr<HeadlessTerminal> terminal_;
+    // Запись, прочитанная open при поиске размера
+    std::optional<SessionEvent> pending_;
+};
@@ -0,0 +1,255 @@
+#include "SpectatorServer.h"
+
+#include "EscapeFormat.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+SpectatorServer::SpectatorServer(const SpectatorServer&) {}
+
+SpectatorServer& SpectatorServer::operator=(const SpectatorServer& other) {
+    if (this != &other) close();
+    return *this;
+}
+
+SpectatorServer::~SpectatorServer() { close(); }
+
+bool SpectatorServer::is_listening() const { return thread_.joinable(); }
+
+bool SpectatorServer::needs_keyframe() const {
+    return keyframe_wanted_.load(std::memory_order_relaxed);
+}
+
+size_t SpectatorServer::get_subscriber_count() const {
+    std::lock_guard lock(mutex_);
+    return subscribers_.size();
+}
+
+void SpectatorServer::publish(Frame diff, Frame keyframe) {
+    if (!is_listening()) return;
+    bool wanted = false;
+    {
+        std::lock_guard lock(mutex_);
+        for (Subscriber& subscriber : subscribers_) {
+            if (subscriber.needs_keyframe && !keyframe) {
+                wanted = true;
+                continue;
+            }
+            const Frame& frame = subscriber.needs_keyframe ? keyframe : diff;
+            if (frame->empty()) continue;
+            if (subscriber.queued_bytes + frame->size() > max_queued_bytes) {
+                // Зритель отстал: очередь сбрасывается, кроме начатого кадра,
+                // иначе он получил бы оборванную последовательность
+                size_t keep = subscriber.offset > 0 ? 1 : 0;
+                while (subscriber.queue.size() > keep) {
+                    subscriber.queue.pop_back();
+                }
+                subscriber.queued_bytes =
+                    keep ? subscriber.queue.front()->size() - subscriber.offset
+                         : 0;
+                subscriber.needs_keyframe = true;
+                wanted = true;
+                continue;
+            }
+            subscriber.queue.push_back(frame);
+            subscriber.queued_bytes += frame->size();
+            subscriber.needs_keyframe = false;
+        }
+        // Под блокировкой: иначе зритель, принятый между ней и записью
+        // флага, остался бы без полного кадра
+        keyframe_wanted_.store(wanted, std::memory_order_relaxed);
+    }
+    wake();
+}
+
+std::string SpectatorServer::encode_screen(const FrameBuffer& screen) {
+    std::string out = "\033[0m\033[2J";
+    ScreenCell pen;
+    for (int y = 0; y < screen.get_height(); ++y) {
+        EscapeFormat::append_cursor_position(out, 0, y);
+        for (int x = 0; x < screen.get_width(); ++x) {
+            const ScreenCell& cell = screen.at(x, y);
+            if (cell.style != pen.style || cell.text_color != pen.text_color ||
+                cell.background_color != pen.background_color) {
+                out += "\033[0";
+                if (cell.style != ConsoleStyle::Reset) {
+                    out += ';';
+                    EscapeFormat::append_uint(out,
+                                              static_cast<uint32_t>(cell.style));
+                }
+                if (cell.text_color) {
+                    out += ';';
+                    out += EscapeFormat::text_color_params[cell.text_color->id]
+                               .view();
+                }
+                if (cell.background_color) {
+                    out += ';';
+                    out += EscapeFormat::background_color_params
+                               [cell.background_color->id]
+                                   .view();
+                }
+                out += 'm';
+                pen = cell;
+            }
+            // После invalidate front-буфер хранит '\0': такая клетка пуста
+            out += cell.glyph == '\0' ? ' ' : cell.glyph;
+        }
+    }
+    out += "\033[0m";
+    return out;
+}
+
+#ifdef _WIN32
+bool SpectatorServer::listen(const std::string&) { return false; }
+void SpectatorServer::close() {}
+void SpectatorServer::run() {}
+void SpectatorServer::accept_subscribers() {}
+bool SpectatorServer::send_queued(Subscriber&) { return false; }
+void SpectatorServer::wake() {}
+#else
+bool SpectatorServer::listen(const std::string& path) {
+    close();
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) return false;
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd_ == -1) return false;
+    ::unlink(path.c_str());
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&address),
+             sizeof(address)) != 0 ||
+        ::listen(listen_fd_, 8) != 0 || pipe(wake_pipe_) != 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    fcntl(listen_fd_, F_SETFL, O_NONBLOCK);
+    fcntl(wake_pipe_[0], F_SETFL, O_NONBLOCK);
+    fcntl(wake_pipe_[1], F_SETFL, O_NONBLOCK);
+    path_ = path;
+    stopping_.store(false);
+    thread_ = std::thread(&SpectatorServer::run, this);
+    return true;
+}
+
+void SpectatorServer::close() {
+    if (!is_listening()) return;
+    stopping_.store(true);
+    wake();
+    thread_.join();
+    for (Subscriber& subscriber : subscribers_) {
+        ::close(subscriber.fd);
+    }
+    subscribers_.clear();
+    keyframe_wanted_.store(false);
+    ::close(listen_fd_);
+    ::close(wake_pipe_[0]);
+    ::close(wake_pipe_[1]);
+    listen_fd_ = wake_pipe_[0] = wake_pipe_[1] = -1;
+    ::unlink(path_.c_str());
+}
+
+void SpectatorServer::wake() {
+    char c = 0;
+    // Переполненный канал уже будит поток
+    [[maybe_unused]] auto written = write(wake_pipe_[1], &c, 1);
+}
+
+void SpectatorServer::run() {
+    std::vector<pollfd> fds;
+    while (!stopping_.load()) {
+        // Список зрителей меняет только этот поток, поэтому индексы в fds
+        // совпадают с subscribers_ и после снятия блокировки
+        fds.assign({{wake_pipe_[0], POLLIN, 0}, {listen_fd_, POLLIN, 0}});
+        {
+            std::lock_guard lock(mutex_);
+            for (const Subscriber& subscriber : subscribers_) {
+                short events = POLLIN;
+                if (!subscriber.queue.empty()) events |= POLLOUT;
+                fds.push_back({subscriber.fd, events, 0});
+            }
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (fds[0].revents & POLLIN) {
+            char buffer[64];
+            while (read(wake_pipe_[0], buffer, sizeof(buffer)) > 0) {
+            }
+        }
+
+        std::lock_guard lock(mutex_);
+        for (size_t i = fds.size(); i-- > 2;) {
+            Subscriber& subscriber = subscribers_[i - 2];
+            bool alive = !(fds[i].revents & (POLLERR | POLLNVAL));
+            if (alive && (fds[i].revents & (POLLIN | POLLHUP))) {
+                // Зрители ничего не присылают: чтение нужно, чтобы заметить
+                // отключение
+                char buffer[256];
+                ssize_t count = recv(subscriber.fd, buffer, sizeof(buffer),
+                                     MSG_DONTWAIT);
+                alive = count > 0 || (count < 0 && (errno == EAGAIN ||
+                                                    errno == EWOULDBLOCK ||
+                                                    errno == EINTR));
+            }
+            if (alive && (fds[i].revents & POLLOUT))
+                alive = send_queued(subscriber);
+            if (!alive) {
+                ::close(subscriber.fd);
+                subscribers_.erase(subscribers_.begin() + (i - 2));
+            }
+        }
+        if (fds[1].revents & POLLIN) accept_subscribers();
+    }
+}
+
+void SpectatorServer::accept_subscribers() {
+    while (true) {
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd == -1) return;
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        Subscriber subscriber;
+        subscriber.fd = fd;
+        subscribers_.push_back(std::move(subscriber));
+        keyframe_wanted_.store(true, std::memory_order_relaxed);
+    }
+}
+
+bool SpectatorServer::send_queued(Subscriber& subscriber) {
+    while (!subscriber.queue.empty()) {
+        const std::string& data = *subscriber.queue.front();
+        ssize_t sent =
+            send(subscriber.fd, data.data() + subscriber.offset,
+                 data.size() - subscriber.offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        subscriber.offset += sent;
+        subscriber.queued_bytes -= sent;
+        if (subscriber.offset == data.size()) {
+            subscriber.queue.pop_front();
+            subscriber.offset = 0;
+        }
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FrameBuffer.h"
+
+// Раздача вывода игры зрителям через Unix-сокет. Кадр кодируется один раз,
+// а все зрители получают один и тот же буфер: в очередях лежат только
+// указатели на него. Отправляет отдельный поток через неблокирующие сокеты,
+// поэтому медленный зритель не задерживает игру: если его очередь слишком
+// выросла, она сбрасывается, и он получит полный кадр заново. Копия
+// объекта начинает без сокета
+class SpectatorServer {
+  public:
+    using Frame = std::shared_ptr<const std::string>;
+    // Больше этого в очереди одного зрителя не копится
+    static constexpr size_t max_queued_bytes = 1 << 20;
+
+    SpectatorServer() = default;
+    SpectatorServer(const SpectatorServer& other);
+    SpectatorServer& operator=(const SpectatorServer& other);
+    ~SpectatorServer();
+
+    // Слушает сокет по пути path; прежний файл сокета удаляется
+    bool listen(const std::string& path);
+    void close();
+    bool is_listening() const;
+
+    // Есть зрители, которым нужен полный кадр: новые или отставшие
+    bool needs_keyframe() const;
+    // diff — вывод в терминал как есть; keyframe — весь экран после него,
+    // его получают только ждущие полного кадра
+    void publish(Frame diff, Frame keyframe);
+    size_t get_subscriber_count() const;
+
+    // Весь экран одной последовательностью: очистка и все клетки по строкам
+    static std::string encode_screen(const FrameBuffer& screen);
+
+  private:
+    struct Subscriber {
+        int fd = -1;
+        std::deque<Frame> queue;
+        size_t offset = 0;
+        size_t queued_bytes = 0;
+        bool needs_keyframe = true;
+    };
+
+    void run();
+    void accept_subscribers();
+    // false — зритель отключился
+    bool send_queued(Subscriber& subscriber);
+    void wake();
+
+    std::string path_;
+    int listen_fd_ = -1;
+    int wake_pipe_[2] = {-1, -1};
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::vector<Subscriber> subscribers_;
+    std::atomic<bool> keyframe_wanted_{false};
+    std::atomic<bool> stopping_{false};
+};
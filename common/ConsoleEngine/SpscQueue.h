@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+// Очередь без блокировок для одного писателя и одного читателя
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+  public:
+    bool try_push(const T& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == Capacity) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ == Capacity) return false;
+        }
+        items_[tail & (Capacity - 1)] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<T> try_pop() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) return std::nullopt;
+        }
+        T value = items_[head & (Capacity - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) ==
+               tail_.load(std::memory_order_acquire);
+    }
+
+  private:
+    static constexpr size_t cache_line = 64;
+
+    alignas(cache_line) std::atomic<size_t> head_{0};
+    size_t tail_cache_ = 0;
+    alignas(cache_line) std::atomic<size_t> tail_{0};
+    size_t head_cache_ = 0;
+    alignas(cache_line) std::array<T, Capacity> items_{};
+};
@@ -0,0 +1,78 @@
+#include "TerminalSize.h"
+
+#include <atomic>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <mutex>
+#endif
+
+namespace TerminalSizeWatch {
+
+#ifdef _WIN32
+// В Windows сигнала об изменении размера нет: движок сравнивает размер сам
+std::optional<TerminalSize> query() {
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info))
+        return std::nullopt;
+    return TerminalSize{info.srWindow.Right - info.srWindow.Left + 1,
+                        info.srWindow.Bottom - info.srWindow.Top + 1};
+}
+
+void watch() {}
+uint32_t get_generation() { return 0; }
+void set_notify_fd(int) {}
+#else
+namespace {
+// В обработчике сигнала допустимы только lock-free атомики и write(2)
+std::atomic<uint32_t> generation{0};
+std::atomic<int> notify_fd{-1};
+struct sigaction previous_action;
+
+void on_resize(int signal) {
+    generation.fetch_add(1, std::memory_order_relaxed);
+    int fd = notify_fd.load(std::memory_order_relaxed);
+    if (fd != -1) {
+        char c = 0;
+        [[maybe_unused]] auto written = write(fd, &c, 1);
+    }
+    if (previous_action.sa_handler != SIG_DFL &&
+        previous_action.sa_handler != SIG_IGN)
+        previous_action.sa_handler(signal);
+}
+}  // namespace
+
+std::optional<TerminalSize> query() {
+    winsize size{};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_col == 0 ||
+        size.ws_row == 0)
+        return std::nullopt;
+    return TerminalSize{size.ws_col, size.ws_row};
+}
+
+void watch() {
+    static std::once_flag installed;
+    std::call_once(installed, [] {
+        struct sigaction action {};
+        action.sa_handler = on_resize;
+        sigemptyset(&action.sa_mask);
+        // Блокирующее чтение (std::getline) не должно прерываться
+        action.sa_flags = SA_RESTART;
+        sigaction(SIGWINCH, &action, &previous_action);
+    });
+}
+
+uint32_t get_generation() {
+    return generation.load(std::memory_order_relaxed);
+}
+
+void set_notify_fd(int fd) { notify_fd.store(fd, std::memory_order_relaxed); }
+#endif
+
+}  // namespace TerminalSizeWatch
@@ -0,0 +1,52 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+
+// Размер экрана терминала в символах
+struct TerminalSize {
+    int width = 0;
+    int height = 0;
+    constexpr bool operator==(const TerminalSize& other) const = default;
+};
+
+// Прямоугольник экрана: вывод за его пределами отбрасывается до того, как
+// превратится в escape-последовательности
+struct ClipRect {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    constexpr int right() const { return x + width; }
+    constexpr int bottom() const { return y + height; }
+    constexpr bool empty() const { return width <= 0 || height <= 0; }
+    constexpr bool contains(int px, int py) const {
+        return px >= x && py >= y && px < right() && py < bottom();
+    }
+    constexpr ClipRect intersect(const ClipRect& other) const {
+        int left = std::max(x, other.x);
+        int top = std::max(y, other.y);
+        int width = std::max(0, std::min(right(), other.right()) - left);
+        int height = std::max(0, std::min(bottom(), other.bottom()) - top);
+        return {left, top, width, height};
+    }
+    constexpr bool operator==(const ClipRect& other) const = default;
+};
+
+// Размер терминала на stdout. Обработчик SIGWINCH только увеличивает счётчик
+// изменений и будит ожидающих ввод через канал, а сам размер запрашивается
+// (ioctl TIOCGWINSZ) уже вне обработчика
+namespace TerminalSizeWatch {
+
+// nullopt, если stdout не терминал
+std::optional<TerminalSize> query();
+// Ставит обработчик SIGWINCH; повторные вызовы ничего не делают
+void watch();
+// Сколько раз приходил SIGWINCH
+uint32_t get_generation();
+// При изменении размера в fd пишется байт, чтобы poll проснулся; -1 — не
+// писать
+void set_notify_fd(int fd);
+
+}  // namespace TerminalSizeWatch
@@ -0,0 +1,51 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Тройной буфер для одного писателя и одного читателя. Писатель заполняет
+// свой слот и публикует его обменом индексов, читатель забирает самый свежий
+// опубликованный слот. Ни одна сторона не ждёт другую: непрочитанный слот
+// при следующей публикации просто переходит обратно к писателю
+template <typename T>
+class TripleBuffer {
+  public:
+    // Слот писателя: принадлежит ему до publish
+    T& write_slot() { return slots_[write_]; }
+
+    // Последний опубликованный слот. Пока он свежий, читать его можно только
+    // под внешней блокировкой, исключающей одновременный take
+    const T& ready_slot() const {
+        return slots_[ready_.load(std::memory_order_acquire) & index_mask];
+    }
+
+    // Возвращает true, если предыдущий опубликованный слот так и не прочитали
+    bool publish() {
+        uint8_t previous = ready_.exchange(write_ | fresh_bit,
+                                           std::memory_order_acq_rel);
+        write_ = previous & index_mask;
+        return previous & fresh_bit;
+    }
+
+    bool has_fresh() const {
+        return ready_.load(std::memory_order_acquire) & fresh_bit;
+    }
+
+    // Самый свежий слот или nullptr, если после прошлого take ничего нового
+    // не публиковали
+    const T* take() {
+        if (!has_fresh()) return nullptr;
+        uint8_t previous = ready_.exchange(read_, std::memory_order_acq_rel);
+        read_ = previous & index_mask;
+        return &slots_[read_];
+    }
+
+  private:
+    static constexpr uint8_t index_mask = 0x3;
+    static constexpr uint8_t fresh_bit = 0x4;
+
+    std::array<T, 3> slots_{};
+    std::atomic<uint8_t> ready_{1};
+    uint8_t write_ = 0;
+    uint8_t read_ = 2;
+};
@@ -0,0 +1,262 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "ConsoleEngine.h"
+#include "EscapeFormat.h"
+#include "InputDecoder.h"
+
+// Скорость пути вывода движка и разбора ввода. Кроме времени итерации
+// каждый случай сообщает ns_per_cell (или ns_per_byte для ввода) и
+// bytes_per_cell — сколько байт уходит в терминал на изменённую клетку.
+// Для отслеживания регрессий результаты пишутся в JSON:
+//   ConsoleEngineBench --benchmark_out=bench.json --benchmark_out_format=json
+// Цифры имеют смысл только для сборки с -DCMAKE_BUILD_TYPE=Release
+
+namespace {
+
+// Терминал, который только считает байты
+class CountingBuffer : public std::streambuf {
+  public:
+    uint64_t get_bytes() const { return bytes_; }
+
+  protected:
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) ++bytes_;
+        return traits_type::not_eof(c);
+    }
+    std::streamsize xsputn(const char*, std::streamsize count) override {
+        bytes_ += count;
+        return count;
+    }
+
+  private:
+    uint64_t bytes_ = 0;
+};
+
+// Движок с кадром width x height, уже выведенным один раз
+struct EngineFixture {
+    std::istringstream in{""};
+    CountingBuffer buffer;
+    std::ostream out{&buffer};
+    ConsoleEngine engine{in, out};
+
+    EngineFixture(int width, int height) {
+        engine.resize_frame(width, height);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                engine.draw_cell(x, y, ScreenCell{'.'});
+            }
+        }
+        engine.present();
+    }
+};
+
+// cells — изменённых клеток за итерацию. Счётчик-частота с kInvert даёт
+// секунды на единицу, поэтому единица взята в миллиардную долю клетки.
+// В консольном отчёте к значению дописывается "s", но это наносекунды
+void report_cells(benchmark::State& state, double cells, uint64_t bytes) {
+    state.counters["ns_per_cell"] = benchmark::Counter(
+        cells * 1e-9, benchmark::Counter::kIsIterationInvariantRate |
+                          benchmark::Counter::kInvert);
+    state.counters["bytes_per_cell"] =
+        static_cast<double>(bytes) / (cells * state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+
+char flip(char glyph) { return glyph == '.' ? '#' : '.'; }
+
+// Каждый кадр меняет все клетки
+void BM_FullRepaint(benchmark::State& state) {
+    const int width = state.range(0);
+    const int height = state.range(1);
+    EngineFixture fixture(width, height);
+    char glyph = '.';
+    uint64_t start = fixture.buffer.get_bytes();
+    for (auto _ : state) {
+        glyph = flip(glyph);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                fixture.engine.draw_cell(x, y, ScreenCell{glyph});
+            }
+        }
+        fixture.engine.present();
+    }
+    report_cells(state, width * height, fixture.buffer.get_bytes() - start);
+}
+BENCHMARK(BM_FullRepaint)->Args({80, 24})->Args({200, 60});
+
+// Каждый кадр меняет range(0) процентов клеток в случайных местах экрана
+void BM_SparseUpdates(benchmark::State& state) {
+    constexpr int width = 200;
+    constexpr int height = 60;
+    constexpr int patterns = 16;
+    const int changed = width * height * state.range(0) / 100;
+    EngineFixture fixture(width, height);
+
+    // Заранее выбранные наборы клеток без повторов внутри набора:
+    // генератор не попадает в измерение
+    std::mt19937 random(12345);
+    std::vector<int> all(width * height);
+    std::iota(all.begin(), all.end(), 0);
+    std::vector<std::vector<int>> sets(patterns);
+    for (auto& set : sets) {
+        std::shuffle(all.begin(), all.end(), random);
+        set.assign(all.begin(), all.begin() + changed);
+    }
+    std::vector<char> glyphs(width * height, '.');
+
+    size_t frame = 0;
+    uint64_t start = fixture.buffer.get_bytes();
+    for (auto _ : state) {
+        for (int index : sets[frame++ % patterns]) {
+            glyphs[index] = flip(glyphs[index]);
+            fixture.engine.draw_cell(index % width, index / width,
+                                     ScreenCell{glyphs[index]});
+        }
+        fixture.engine.present();
+    }
+    report_cells(state, changed, fixture.buffer.get_bytes() - start);
+}
+BENCHMARK(BM_SparseUpdates)->Arg(1)->Arg(10);
+
+// Полная перерисовка, цвет меняется каждые range(0) клеток строки
+void BM_ColoredRuns(benchmark::State& state) {
+    constexpr int width = 200;
+    constexpr int height = 60;
+    const int run = state.range(0);
+    EngineFixture fixture(width, height);
+    char glyph = '.';
+    int shift = 0;
+    uint64_t start = fixture.buffer.get_bytes();
+    for (auto _ : state) {
+        glyph = flip(glyph);
+        ++shift;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int color = x / run + y * 7 + shift;
+                fixture.engine.draw_cell(
+                    x, y, ScreenCell{glyph, Color256{color}, Color256{~color}});
+            }
+        }
+        fixture.engine.present();
+    }
+    report_cells(state, width * height, fixture.buffer.get_bytes() - start);
+}
+BENCHMARK(BM_ColoredRuns)->Arg(1)->Arg(8)->Arg(80);
+
+// Изменённые клетки разделены range(0) - 1 неизменными: каждая требует
+// перемещения курсора
+void BM_CursorJumps(benchmark::State& state) {
+    constexpr int width = 200;
+    constexpr int height = 60;
+    const int stride = state.range(0);
+    EngineFixture fixture(width, height);
+    char glyph = '.';
+    int cells = 0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = y % stride; x < width; x += stride) ++cells;
+    }
+    uint64_t start = fixture.buffer.get_bytes();
+    for (auto _ : state) {
+        glyph = flip(glyph);
+        for (int y = 0; y < height; ++y) {
+            for (int x = y % stride; x < width; x += stride) {
+                fixture.engine.draw_cell(x, y, ScreenCell{glyph});
+            }
+        }
+        fixture.engine.present();
+    }
+    report_cells(state, cells, fixture.buffer.get_bytes() - start);
+}
+BENCHMARK(BM_CursorJumps)->Arg(3)->Arg(16);
+
+// Поток ввода: буквы вперемешку со стрелками, модификаторами, F-клавишами
+void BM_InputDecoding(benchmark::State& state) {
+    std::string input;
+    while (input.size() < 4096) {
+        input += "wasd";
+        input += "\033[A\033[B\033[1;5C\033[1;2D";
+        input += "\033OP\033[15~\033[3~";
+        input += " \r";
+    }
+    InputDecoder decoder;
+    KeyEvent event;
+    const auto time = InputDecoder::Clock::now();
+    for (auto _ : state) {
+        int events = 0;
+        for (char c : input) events += decoder.feed(c, time, event);
+        events += decoder.finish(event);
+        benchmark::DoNotOptimize(events);
+        benchmark::DoNotOptimize(event);
+    }
+    state.counters["ns_per_byte"] = benchmark::Counter(
+        input.size() * 1e-9, benchmark::Counter::kIsIterationInvariantRate |
+                                 benchmark::Counter::kInvert);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            input.size());
+}
+BENCHMARK(BM_InputDecoding);
+
+// Форматирование кадра без движка: прежний путь через operator<< и запись
+// через EscapeFormat в переиспользуемый буфер
+constexpr int format_width = 100;
+constexpr int format_height = 20;
+
+uint8_t color_for(int x, int y) { return static_cast<uint8_t>(x * 7 + y * 13); }
+
+void BM_FormatOstream(benchmark::State& state) {
+    std::ostringstream stream;
+    uint64_t bytes = 0;
+    for (auto _ : state) {
+        stream.str("");
+        for (int y = 0; y < format_height; ++y) {
+            for (int x = 0; x < format_width; ++x) {
+                stream << "\033[" << (y + 1) << ";" << (x + 1) << "H";
+                stream << "\033[38;5;" << static_cast<int>(color_for(x, y))
+                       << "m";
+                stream << "\033[48;5;" << static_cast<int>(color_for(y, x))
+                       << "m" << '.';
+            }
+        }
+        bytes += static_cast<uint64_t>(stream.tellp());
+    }
+    report_cells(state, format_width * format_height, bytes);
+}
+BENCHMARK(BM_FormatOstream);
+
+void BM_FormatEscape(benchmark::State& state) {
+    std::string buffer;
+    uint64_t bytes = 0;
+    for (auto _ : state) {
+        buffer.clear();
+        for (int y = 0; y < format_height; ++y) {
+            for (int x = 0; x < format_width; ++x) {
+                EscapeFormat::append_cursor_position(buffer, x, y);
+                buffer += "\033[";
+                buffer += EscapeFormat::text_color_params[color_for(x, y)].view();
+                buffer += "m\033[";
+                buffer +=
+                    EscapeFormat::background_color_params[color_for(y, x)].view();
+                buffer += "m.";
+            }
+        }
+        benchmark::DoNotOptimize(buffer.data());
+        bytes += buffer.size();
+    }
+    report_cells(state, format_width * format_height, bytes);
+}
+BENCHMARK(BM_FormatEscape);
+
+}  // namespace
+
+BENCHMARK_MAIN();
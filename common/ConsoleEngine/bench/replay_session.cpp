@@ -0,0 +1,39 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "SessionReplayer.h"
+
+// Проигрывает журнал, записанный игрой с -record=FILE, на HeadlessTerminal
+// и печатает итоговый экран и стоимость вывода. Один и тот же журнал даёт
+// одинаковую нагрузку на разных сборках:
+//   ConsoleEngineReplay FILE [-realtime]
+// -realtime — с паузами, как при записи; по умолчанию без пауз
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " FILE [-realtime]\n";
+        return 2;
+    }
+    auto pace = SessionReplayer::Pace::Max;
+    for (int i = 2; i < argc; ++i) {
+        if (std::string_view(argv[i]) == "-realtime")
+            pace = SessionReplayer::Pace::Recorded;
+    }
+    SessionReplayer replayer;
+    if (!replayer.open(argv[1])) {
+        std::cerr << "Cannot read session log " << argv[1] << "\n";
+        return 1;
+    }
+    SessionReplayer::Result result = replayer.play(pace);
+    replayer.get_terminal().write_report(std::cout);
+    using std::chrono::duration;
+    std::cout << "outputs: " << result.outputs << "\n"
+              << "keys: " << result.keys << ", lines: " << result.lines
+              << ", resizes: " << result.resizes << "\n"
+              << "recorded: "
+              << duration<double>(result.recorded_time).count() << " s\n"
+              << "replayed: "
+              << duration<double>(result.replay_time).count() << " s\n";
+    return 0;
+}
@@ -1,9 +1,52 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
 #include <iostream>
+#include <memory>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #include "ConsoleEngine.h"
+#include "EscapeFormat.h"
+#include "GameOptions.h"
+#include "HeadlessTerminal.h"
+#include "InputDecoder.h"
+#include "OutputBacklog.h"
+#include "RenderThread.h"
+#include "SessionLog.h"
+#include "SessionReplayer.h"
+#include "SpectatorServer.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#endif
+
+// Счётчик выделений памяти: кадр в установившемся режиме не должен выделять
+namespace {
+std::atomic<bool> count_allocations{false};
+std::atomic<size_t> allocations{0};
+}  // namespace
+
+void* operator new(size_t size) {
+    if (count_allocations.load(std::memory_order_relaxed)) ++allocations;
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
 
 class ConsoleEngineTest : public ::testing::Test {
   protected:
@@ -110,4 +153,996 @@ TEST_F(ConsoleEngineTest, Get) {
     in.str("aadd\nwwss");
     EXPECT_EQ(engine->get(), "aadd");
     EXPECT_EQ(engine->get(), "wwss");
-}
\ No newline at end of file
+}
+
+TEST_F(ConsoleEngineTest, PresentDrawsWholeFrameFirstTime) {
+    engine->reset_styles();
+    clear_out();
+    engine->resize_frame(3, 1);
+    engine->draw_text(0, 0, "abc");
+    engine->present();
+    EXPECT_EQ(out.str(), "\033[1;1Habc");
+}
+
+TEST_F(ConsoleEngineTest, PresentSendsOnlyChangedCells) {
+    engine->resize_frame(4, 2);
+    engine->draw_text(0, 0, "....");
+    engine->draw_text(0, 1, "....");
+    engine->present();
+    clear_out();
+
+    engine->draw_cell(2, 1, ScreenCell{'#'});
+    engine->present();
+    EXPECT_EQ(out.str(), "\033[2;3H#");
+    clear_out();
+
+    engine->present();
+    EXPECT_EQ(out.str(), "");
+}
+
+TEST_F(ConsoleEngineTest, PresentAppliesCellColors) {
+    engine->reset_styles();
+    clear_out();
+    engine->resize_frame(1, 1);
+    engine->draw_cell(0, 0, ScreenCell{'x', Color256{101}, Color256{240}});
+    engine->present();
+    EXPECT_EQ(out.str(), "\033[1;1H\033[38;5;101;48;5;240mx\033[0m");
+}
+
+TEST_F(ConsoleEngineTest, ClearMakesBlankCellsUpToDate) {
+    engine->resize_frame(3, 1);
+    engine->clear();
+    clear_out();
+    engine->draw_text(0, 0, " x ");
+    engine->present();
+    EXPECT_EQ(out.str(), "\033[1;2Hx");
+}
+
+TEST_F(ConsoleEngineTest, InvalidateRepaintsEverything) {
+    engine->resize_frame(2, 1);
+    engine->draw_text(0, 0, "ab");
+    engine->present();
+    clear_out();
+    engine->invalidate();
+    engine->present();
+    EXPECT_EQ(out.str(), "\033[1;1Hab");
+}
+
+TEST_F(ConsoleEngineTest, FrameHoldsOutputUntilEnd) {
+    engine->begin_frame();
+    engine->set_cursor_to_pos(0, 0);
+    engine->print("ab");
+    engine->hide_cursor();
+    EXPECT_EQ(out.str(), "");
+    engine->end_frame();
+    EXPECT_EQ(out.str(), "\033[1;1Hab\033[?25l");
+    EXPECT_EQ(engine->get_avoided_flushes(), 2);
+}
+
+TEST_F(ConsoleEngineTest, NestedFramesWriteOnOutermostEnd) {
+    engine->begin_frame();
+    engine->begin_frame();
+    engine->print('x');
+    engine->end_frame();
+    EXPECT_EQ(out.str(), "");
+    engine->end_frame();
+    EXPECT_EQ(out.str(), "x");
+}
+
+TEST_F(ConsoleEngineTest, PrintFormatsMixedArguments) {
+    engine->print("n=", 42, ' ', -7, ' ', 1.5, ' ', std::string("s"));
+    EXPECT_EQ(out.str(), "n=42 -7 1.5 s");
+}
+
+TEST_F(ConsoleEngineTest, PrintFmtFormatsIntoOutput) {
+    engine->print_fmt<"n={} {} {} {} {{}}">(42, -7, 1.5, std::string("s"));
+    EXPECT_EQ(out.str(), "n=42 -7 1.5 s {}");
+    clear_out();
+    engine->print_fmt<"[{:>4}|{:<3}|{:^5}|{:*^{}}|{}]">(12, 'a', "ab", "", 3,
+                                                       true);
+    EXPECT_EQ(out.str(), "[  12|a  | ab  |***|true]");
+}
+
+TEST(FrameAllocationTest, SteadyStateFrameAllocatesNothing) {
+    std::istringstream in("");
+    std::ostream discard(nullptr);
+    ConsoleEngine engine(in, discard);
+    engine.resize_frame(20, 2);
+    auto frame = [&](int score) {
+        engine.draw_fmt<"Score: {}">(0, 0, score);
+        engine.draw_text(0, 1, "....................");
+        engine.set_cursor_to_pos(0, 3);
+        engine.print_fmt<"{:>{}}">('v', score % 10 + 1);
+        engine.present();
+    };
+    for (int score = 0; score < 3; ++score) frame(score);
+    allocations = 0;
+    count_allocations = true;
+    for (int score = 1000; score < 1100; ++score) frame(score);
+    count_allocations = false;
+    EXPECT_EQ(allocations.load(), 0u);
+}
+
+TEST_F(ConsoleEngineTest, SameStyledRunHasSingleEscape) {
+    engine->reset_styles();
+    clear_out();
+    engine->begin_frame();
+    for (int i = 0; i < 3; ++i) {
+        engine->print_color(Colors256::GrayBrown, '.');
+        engine->reset_styles();
+    }
+    engine->end_frame();
+    EXPECT_EQ(out.str(), "\033[38;5;101m...\033[0m");
+}
+
+TEST_F(ConsoleEngineTest, OnlyChangedSgrParamsAreSent) {
+    engine->reset_styles();
+    engine->set_color(ConsoleTextColors::Red);
+    clear_out();
+    engine->set_color(ConsoleTextColors::Red, ConsoleBkgColors::Blue);
+    EXPECT_EQ(out.str(), "\033[44m");
+    clear_out();
+    engine->set_color(ConsoleTextColors::Red);
+    EXPECT_EQ(out.str(), "");
+}
+
+TEST_F(ConsoleEngineTest, DroppedAttributeResetsAndReapplies) {
+    engine->reset_styles();
+    engine->set_style(ConsoleStyle::Bold);
+    engine->set_color(ConsoleTextColors::Green);
+    clear_out();
+    engine->begin_frame();
+    engine->reset_styles();
+    engine->set_color(ConsoleTextColors::Green);
+    engine->print('x');
+    engine->end_frame();
+    EXPECT_EQ(out.str(), "\033[0;32mx");
+}
+
+TEST_F(ConsoleEngineTest, PresentMergesStyledRuns) {
+    engine->reset_styles();
+    clear_out();
+    engine->resize_frame(3, 1);
+    for (int x = 0; x < 3; ++x) {
+        engine->draw_cell(x, 0, ScreenCell{'.', Colors256::GrayBrown});
+    }
+    engine->present();
+    EXPECT_EQ(out.str(), "\033[1;1H\033[38;5;101m...\033[0m");
+}
+
+TEST_F(ConsoleEngineTest, GetNoWaitReadsAvailableInput) {
+    in.str("ad");
+    EXPECT_EQ(engine->get_no_wait(), 'a');
+    EXPECT_EQ(engine->get_no_wait(), 'd');
+    EXPECT_EQ(engine->get_no_wait(), '\0');
+}
+
+TEST(SpscQueueTest, PushPopKeepsOrderAndCapacity) {
+    SpscQueue<int, 4> queue;
+    EXPECT_FALSE(queue.try_pop().has_value());
+    for (int i = 0; i < 4; ++i) EXPECT_TRUE(queue.try_push(i));
+    EXPECT_FALSE(queue.try_push(4));
+    for (int i = 0; i < 4; ++i) EXPECT_EQ(queue.try_pop(), i);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueueTest, TransfersBetweenThreads) {
+    SpscQueue<int, 64> queue;
+    constexpr int count = 100000;
+    std::thread producer([&] {
+        for (int i = 0; i < count; ++i) {
+            while (!queue.try_push(i)) std::this_thread::yield();
+        }
+    });
+    int expected = 0;
+    while (expected < count) {
+        if (auto value = queue.try_pop()) {
+            ASSERT_EQ(*value, expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+}
+
+TEST_F(ConsoleEngineTest, KeyPressedDoesNotSwallowOtherKeys) {
+    in.str("d");
+    EXPECT_FALSE(engine->key_pressed('A'));
+    EXPECT_TRUE(engine->key_pressed('D'));
+    EXPECT_FALSE(engine->key_pressed('D'));
+    EXPECT_EQ(engine->get_no_wait(), 'd');
+}
+
+TEST_F(ConsoleEngineTest, KeyPressedReturnsEachQueuedPress) {
+    // Два нажатия за один тик игры — два хода
+    in.str("dd");
+    EXPECT_TRUE(engine->key_pressed('D'));
+    EXPECT_TRUE(engine->key_pressed('D'));
+    EXPECT_EQ(engine->snapshot_keys().press_count('d'), 2);
+}
+
+TEST_F(ConsoleEngineTest, SnapshotCountsPressesPerFrame) {
+    in.str("aab");
+    KeySnapshot snapshot = engine->snapshot_keys();
+    EXPECT_EQ(snapshot.press_count('a'), 2);
+    EXPECT_TRUE(snapshot.pressed('B'));
+    EXPECT_FALSE(snapshot.pressed('c'));
+    EXPECT_FALSE(engine->snapshot_keys().pressed('a'));
+}
+
+TEST(KeyboardStateTest, AutoRepeatMeansHeld) {
+    using namespace std::chrono_literals;
+    KeyboardState keyboard;
+    auto start = KeyboardState::Clock::now();
+    auto w = KeyEvent::from_char('w');
+    keyboard.record(KeyEvent{w, 0, start});
+    EXPECT_FALSE(keyboard.is_held(w, start + 10ms));
+    keyboard.record(KeyEvent{w, 0, start + 500ms});
+    keyboard.record(KeyEvent{w, 0, start + 530ms});
+    EXPECT_TRUE(keyboard.is_held(KeyEvent::from_char('W'), start + 560ms));
+    EXPECT_FALSE(
+        keyboard.is_held(w, start + 530ms + KeyboardState::release_timeout));
+    EXPECT_EQ(keyboard.last_seen(w), start + 530ms);
+}
+
+TEST(KeyboardStateTest, EachPressIsConsumedSeparately) {
+    using namespace std::chrono_literals;
+    KeyboardState keyboard;
+    auto start = KeyboardState::Clock::now();
+    auto a = KeyEvent::from_char('a');
+    keyboard.record(KeyEvent{a, 0, start});
+    keyboard.record(KeyEvent{a, 0, start + 150ms});
+    EXPECT_TRUE(keyboard.consume_press(a));
+    EXPECT_TRUE(keyboard.consume_press(a));
+    EXPECT_FALSE(keyboard.consume_press(a));
+}
+
+TEST(KeyboardStateTest, AutoRepeatKeepsOnePendingPress) {
+    using namespace std::chrono_literals;
+    KeyboardState keyboard;
+    auto start = KeyboardState::Clock::now();
+    auto w = KeyEvent::from_char('w');
+    keyboard.record(KeyEvent{w, 0, start});
+    // Автоповтор: первый через 500 мс, дальше каждые 30 мс. До первого
+    // повтора клавиша ещё не удерживается, поэтому в очереди два нажатия
+    for (int i = 0; i < 20; ++i)
+        keyboard.record(KeyEvent{w, 0, start + 500ms + i * 30ms});
+    EXPECT_TRUE(keyboard.consume_press(w));
+    EXPECT_TRUE(keyboard.consume_press(w));
+    EXPECT_FALSE(keyboard.consume_press(w));
+    // Игра забрала нажатие — следующий повтор снова ставит одно в очередь
+    keyboard.record(KeyEvent{w, 0, start + 1100ms});
+    EXPECT_TRUE(keyboard.consume_press(w));
+    EXPECT_FALSE(keyboard.consume_press(w));
+}
+
+class InputDecoderTest : public ::testing::Test {
+  protected:
+    InputDecoder decoder;
+    InputDecoder::Clock::time_point now = InputDecoder::Clock::now();
+
+    std::vector<KeyEvent> feed(std::string_view bytes) {
+        std::vector<KeyEvent> events;
+        KeyEvent event;
+        for (char c : bytes) {
+            if (decoder.feed(c, now, event)) events.push_back(event);
+        }
+        return events;
+    }
+};
+
+TEST_F(InputDecoderTest, PlainCharacters) {
+    auto events = feed("w\n");
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(events[0].get_char(), 'w');
+    EXPECT_EQ(events[1].code, KeyCode::Enter);
+}
+
+TEST_F(InputDecoderTest, ArrowAndTildeKeys) {
+    auto events = feed("\033[A\033OB\033[3~\033[1;5C\033[15~");
+    ASSERT_EQ(events.size(), 5);
+    EXPECT_EQ(events[0].code, KeyCode::Up);
+    EXPECT_EQ(events[1].code, KeyCode::Down);
+    EXPECT_EQ(events[2].code, KeyCode::Delete);
+    EXPECT_EQ(events[3].code, KeyCode::Right);
+    EXPECT_EQ(events[3].modifiers, KeyModifiers::Ctrl);
+    EXPECT_EQ(events[4].code, KeyCode::F5);
+    EXPECT_FALSE(decoder.waiting());
+}
+
+TEST_F(InputDecoderTest, LoneEscapeWaitsForTimeout) {
+    EXPECT_TRUE(feed("\033").empty());
+    EXPECT_TRUE(decoder.waiting());
+    KeyEvent event;
+    EXPECT_FALSE(decoder.expire(now, event));
+    EXPECT_TRUE(decoder.expire(now + InputDecoder::escape_timeout, event));
+    EXPECT_EQ(event.code, KeyCode::Escape);
+    EXPECT_FALSE(decoder.waiting());
+}
+
+TEST_F(InputDecoderTest, AltAndDoubleEscape) {
+    auto events = feed("\033x\033\033[D");
+    ASSERT_EQ(events.size(), 3);
+    EXPECT_EQ(events[0].get_char(), 'x');
+    EXPECT_EQ(events[0].modifiers, KeyModifiers::Alt);
+    EXPECT_EQ(events[1].code, KeyCode::Escape);
+    EXPECT_EQ(events[2].code, KeyCode::Left);
+}
+
+TEST_F(InputDecoderTest, UnknownSequencesAreDropped) {
+    auto events = feed("\033[?1;2c\033[200~a");
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_EQ(events[0].get_char(), 'a');
+}
+
+TEST_F(ConsoleEngineTest, ArrowKeyIsNotEscape) {
+    in.str("\033[Aw\033");
+    auto event = engine->get_key_no_wait();
+    ASSERT_TRUE(event.has_value());
+    EXPECT_EQ(event->code, KeyCode::Up);
+    EXPECT_EQ(engine->get_no_wait(), 'w');
+    EXPECT_EQ(engine->get_no_wait(), 27);
+    EXPECT_EQ(engine->get_no_wait(), '\0');
+}
+
+TEST(EscapeFormatTest, WritesUnsignedNumbers) {
+    for (uint32_t value : {0u, 7u, 10u, 99u, 100u, 12345u, 4294967295u}) {
+        std::string out;
+        EscapeFormat::append_uint(out, value);
+        EXPECT_EQ(out, std::to_string(value));
+    }
+}
+
+TEST(EscapeFormatTest, ColorTablesMatchSgrSyntax) {
+    EXPECT_EQ(EscapeFormat::text_color_params[0].view(), "38;5;0");
+    EXPECT_EQ(EscapeFormat::text_color_params[101].view(), "38;5;101");
+    EXPECT_EQ(EscapeFormat::background_color_params[255].view(), "48;5;255");
+}
+
+TEST(EscapeFormatTest, CursorPosition) {
+    std::string out = "x";
+    EscapeFormat::append_cursor_position(out, 99, 19);
+    EXPECT_EQ(out, "x\033[20;100H");
+}
+
+class HeadlessTerminalTest : public ::testing::Test {
+  protected:
+    HeadlessTerminal terminal{8, 3};
+    std::istringstream input;
+    std::unique_ptr<ConsoleEngine> engine;
+
+    void SetUp() override {
+        engine = std::make_unique<ConsoleEngine>(input, terminal.stream());
+        engine->resize_frame(8, 3);
+    }
+};
+
+TEST_F(HeadlessTerminalTest, PresentFillsScreen) {
+    engine->draw_text(1, 0, "ab", Colors256::Red);
+    engine->draw_text(0, 2, "xyz", std::nullopt, Color256{240});
+    engine->present();
+
+    EXPECT_EQ(terminal.row_text(0), " ab     ");
+    EXPECT_EQ(terminal.row_text(2), "xyz     ");
+    EXPECT_EQ(terminal.at(1, 0).text_color, Colors256::Red);
+    EXPECT_EQ(terminal.at(2, 2).background_color, Color256{240});
+    EXPECT_FALSE(terminal.at(3, 2).background_color.has_value());
+}
+
+TEST_F(HeadlessTerminalTest, CountsWorkOfLastFrame) {
+    engine->present();
+    ASSERT_EQ(terminal.get_frame_count(), 1u);
+    EXPECT_EQ(terminal.get_last_frame().cells_touched, 24u);
+
+    engine->draw_text(2, 1, "q");
+    engine->present();
+    EXPECT_EQ(terminal.get_frame_count(), 2u);
+    EXPECT_EQ(engine->get_last_frame_stats().cells_changed, 1u);
+    // Только перемещение курсора: стиль клетки не менялся
+    EXPECT_EQ(terminal.get_last_frame().sequences, 1u);
+    EXPECT_EQ(terminal.at(2, 1).glyph, 'q');
+}
+
+TEST_F(HeadlessTerminalTest, ClearAndCursorVisibility) {
+    engine->print("abc");
+    engine->hide_cursor();
+    EXPECT_FALSE(terminal.is_cursor_visible());
+    EXPECT_EQ(terminal.get_cursor_x(), 3);
+
+    engine->clear();
+    EXPECT_EQ(terminal.row_text(0), "        ");
+    EXPECT_EQ(terminal.get_cursor_x(), 0);
+}
+
+TEST_F(HeadlessTerminalTest, BasicColorsAndScrolling) {
+    engine->print_color(ConsoleTextColors::Green, ConsoleBkgColors::Blue, "g");
+    engine->print("\n1\n2\n3");
+    EXPECT_EQ(terminal.row_text(0), "1       ");
+    EXPECT_EQ(terminal.row_text(2), "3       ");
+    EXPECT_EQ(terminal.get_cursor_y(), 2);
+
+    engine->set_cursor_to_zero();
+    engine->print_color(ConsoleTextColors::Green, ConsoleBkgColors::Blue, "g");
+    EXPECT_EQ(terminal.at(0, 0).text_color, Color256{2});
+    EXPECT_EQ(terminal.at(0, 0).background_color, Color256{4});
+}
+
+TEST(HeadlessEngineTest, DefaultEngineUsesDefaultStreams) {
+    HeadlessTerminal terminal(4, 1);
+    std::istringstream input("d");
+    ConsoleEngine::set_default_streams(input, terminal.stream());
+    {
+        ConsoleEngine engine;
+        EXPECT_FALSE(engine.has_terminal());
+        engine.print("hi");
+        EXPECT_EQ(terminal.row_text(0), "hi  ");
+        EXPECT_EQ(engine.get_no_wait(), 'd');
+    }
+    ConsoleEngine::reset_default_streams();
+}
+
+TEST_F(ConsoleEngineTest, FrameStatsDescribeWrittenOutput) {
+    engine->resize_frame(3, 1);
+    engine->draw_text(0, 0, "ab", Colors256::Red);
+    clear_out();
+    engine->present();
+
+    ASSERT_EQ(engine->get_frame_stats().size(), 1u);
+    const FrameStats& stats = engine->get_last_frame_stats();
+    std::string written = out.str();
+    EXPECT_EQ(stats.bytes, written.size());
+    EXPECT_EQ(stats.sequences,
+              std::count(written.begin(), written.end(), '\033'));
+    EXPECT_EQ(stats.cells_changed, 3u);
+    EXPECT_EQ(stats.flushes, 1u);
+
+    engine->present();
+    EXPECT_EQ(engine->get_last_frame_stats().cells_changed, 0u);
+}
+
+TEST_F(ConsoleEngineTest, OutputOutsideFrameCountsTowardsNextFrame) {
+    engine->clear();
+    engine->begin_frame();
+    engine->print("x");
+    engine->end_frame();
+
+    ASSERT_EQ(engine->get_frame_stats().size(), 1u);
+    EXPECT_EQ(engine->get_last_frame_stats().flushes, 2u);
+    EXPECT_EQ(engine->get_last_frame_stats().bytes, out.str().size());
+}
+
+TEST_F(ConsoleEngineTest, EngineCopyStartsWithEmptyStats) {
+    engine->set_stats_options({false, "unused.csv"});
+    engine->present();
+    ConsoleEngine copy = *engine;
+    EXPECT_TRUE(copy.get_frame_stats().empty());
+    EXPECT_EQ(engine->get_frame_stats().size(), 1u);
+    engine->set_stats_options({});
+}
+
+TEST(RenderStatsTest, WritesCsvRowPerFrame) {
+    RenderStats stats;
+    auto now = RenderStats::Clock::now();
+    stats.begin_frame();
+    stats.record_write("\033[Hab", true, now, now);
+    stats.add_cells_changed(2);
+    stats.end_frame();
+
+    std::ostringstream csv;
+    stats.write_csv(csv);
+    EXPECT_EQ(csv.str(),
+              "frame,bytes,sequences,cells_changed,flushes,format_us,write_us\n"
+              "1,5,1,2,1,0,0\n");
+}
+
+TEST_F(HeadlessTerminalTest, StatsOverlayIsDrawnBelowFrame) {
+    engine->resize_frame(8, 2);
+    engine->set_stats_options({true, ""});
+    engine->draw_text(0, 0, "a");
+    engine->present();
+    engine->present();
+
+    EXPECT_EQ(terminal.row_text(2).substr(0, 8), "frame 1 ");
+    EXPECT_EQ(terminal.row_text(0).substr(0, 1), "a");
+    // Курсор возвращён туда, где его оставил кадр
+    EXPECT_EQ(terminal.get_cursor_y(), 1);
+}
+
+TEST_F(HeadlessTerminalTest, ScrollRowsShiftsScreenAndFrontBuffer) {
+    engine->draw_text(0, 0, "head");
+    engine->draw_text(0, 1, "a");
+    engine->draw_text(0, 2, "b");
+    engine->present();
+
+    engine->scroll_rows(1, 2, 1);
+    EXPECT_EQ(terminal.row_text(0), "head    ");
+    EXPECT_EQ(terminal.row_text(1), "        ");
+    EXPECT_EQ(terminal.row_text(2), "a       ");
+
+    // Совпадающие после сдвига клетки не отправляются
+    engine->draw_text(0, 1, "c");
+    engine->draw_text(0, 2, "a");
+    engine->present();
+    EXPECT_EQ(engine->get_last_frame_stats().cells_changed, 1u);
+    EXPECT_EQ(terminal.row_text(1), "c       ");
+    EXPECT_EQ(terminal.row_text(2), "a       ");
+}
+
+TEST_F(HeadlessTerminalTest, ScrollUpWithinRegion) {
+    engine->draw_text(0, 0, "x");
+    engine->draw_text(0, 1, "y");
+    engine->draw_text(0, 2, "z");
+    engine->present();
+
+    engine->scroll_rows(0, 1, -1);
+    EXPECT_EQ(terminal.row_text(0), "y       ");
+    EXPECT_EQ(terminal.row_text(1), "        ");
+    EXPECT_EQ(terminal.row_text(2), "z       ");
+}
+
+TEST_F(ConsoleEngineTest, SuggestedScrollIsUsedOnlyWhenCheaper) {
+    engine->resize_frame(20, 3);
+    engine->draw_text(0, 0, "01234567890123456789");
+    engine->draw_text(0, 1, "abcdefghijabcdefghij");
+    engine->present();
+
+    // Две строки уехали вниз — прокрутка дешевле перерисовки
+    engine->draw_text(0, 0, "                    ");
+    engine->draw_text(0, 1, "01234567890123456789");
+    engine->draw_text(0, 2, "abcdefghijabcdefghij");
+    engine->suggest_scroll(0, 2, 1);
+    clear_out();
+    engine->present();
+    EXPECT_NE(out.str().find("\033[1;3r\033[1T\033[r"), std::string::npos);
+    EXPECT_EQ(engine->get_last_frame_stats().cells_changed, 0u);
+
+    // Изменилась одна клетка — прокрутка не нужна
+    engine->draw_text(0, 0, "x");
+    engine->suggest_scroll(0, 2, 1);
+    clear_out();
+    engine->present();
+    EXPECT_EQ(out.str().find('T'), std::string::npos);
+    EXPECT_EQ(engine->get_last_frame_stats().cells_changed, 1u);
+}
+
+TEST_F(HeadlessTerminalTest, ShrunkTerminalClipsFrame) {
+    terminal.resize(4, 2);
+    engine->set_terminal_size(TerminalSize{4, 2});
+    EXPECT_TRUE(engine->poll_resize());
+    EXPECT_FALSE(engine->poll_resize());
+    EXPECT_EQ(engine->get_clip(), (ClipRect{0, 0, 4, 2}));
+
+    engine->draw_text(0, 0, "abcdefgh");
+    engine->draw_text(0, 2, "hidden");
+    engine->present();
+    EXPECT_EQ(terminal.row_text(0), "abcd");
+    // Невидимые клетки не отправляются и не переносятся на новую строку
+    EXPECT_EQ(engine->get_last_frame_stats().cells_changed, 8u);
+    EXPECT_EQ(terminal.row_text(1), "    ");
+}
+
+TEST_F(HeadlessTerminalTest, GrownTerminalIsRepaintedWithoutClear) {
+    engine->draw_text(0, 0, "abc");
+    engine->present();
+
+    terminal.resize(10, 4);
+    engine->set_terminal_size(TerminalSize{10, 4});
+    engine->present();
+    // Всё видимое отправлено заново, поля вне кадра стёрты без ESC[2J
+    EXPECT_EQ(engine->get_last_frame_stats().cells_changed, 24u);
+    EXPECT_EQ(terminal.row_text(0), "abc       ");
+    EXPECT_EQ(terminal.row_text(3), "          ");
+    EXPECT_TRUE(engine->poll_resize());
+
+    engine->present();
+    EXPECT_EQ(engine->get_last_frame_stats().bytes, 0u);
+}
+
+TEST_F(ConsoleEngineTest, UserClipLimitsDrawAndPresent) {
+    engine->resize_frame(6, 3);
+    engine->set_clip(ClipRect{2, 1, 10, 10});
+    EXPECT_EQ(engine->get_clip(), (ClipRect{2, 1, 4, 2}));
+    engine->draw_text(0, 1, "abcdef");
+    clear_out();
+    engine->present();
+    EXPECT_EQ(out.str(), "\033[2;3H\033[0mcdef\033[3;3H    ");
+
+    engine->reset_clip();
+    EXPECT_EQ(engine->get_clip(), (ClipRect{0, 0, 6, 3}));
+}
+
+TEST(TripleBufferTest, ReaderGetsNewestSlot) {
+    TripleBuffer<int> buffer;
+    EXPECT_EQ(buffer.take(), nullptr);
+    buffer.write_slot() = 1;
+    EXPECT_FALSE(buffer.publish());
+    buffer.write_slot() = 2;
+    // Первый кадр не прочитан и заменён вторым
+    EXPECT_TRUE(buffer.publish());
+    const int* value = buffer.take();
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(*value, 2);
+    EXPECT_EQ(buffer.take(), nullptr);
+}
+
+TEST(RenderThreadTest, SlowOutputSkipsToNewestFrame) {
+    std::mutex gate;
+    std::atomic<bool> entered{false};
+    std::vector<int> rendered;
+    std::vector<int> lines;
+    RenderThread thread;
+    thread.start([&](const FrameSnapshot& snapshot) {
+        entered = true;
+        std::lock_guard lock(gate);
+        rendered.push_back(snapshot.cells.get_width());
+        lines.push_back(snapshot.params.scroll_hint
+                            ? snapshot.params.scroll_hint->lines
+                            : 0);
+    });
+
+    std::unique_lock hold(gate);
+    for (int width = 1; width <= 4; ++width) {
+        FrameSnapshot& frame = thread.next_frame();
+        frame.cells.resize(width, 1);
+        frame.params.scroll_hint = ScrollHint{0, 0, 1};
+        thread.publish();
+        // Поток забрал первый кадр и завис на выводе
+        while (!entered) std::this_thread::yield();
+    }
+    hold.unlock();
+    thread.wait_idle();
+
+    // Второй и третий кадры заменены четвёртым, их сдвиг перешёл к нему
+    EXPECT_EQ(rendered, (std::vector<int>{1, 4}));
+    EXPECT_EQ(lines, (std::vector<int>{1, 3}));
+    EXPECT_EQ(thread.get_dropped_frames(), 2u);
+}
+
+TEST_F(HeadlessTerminalTest, RenderThreadKeepsOutputOrder) {
+    engine->set_render_thread(true);
+    engine->draw_text(0, 0, "ab");
+    engine->present();
+    engine->draw_text(0, 0, "cd");
+    engine->present();
+    // Прямой вывод ждёт, пока поток выведет опубликованный кадр
+    engine->set_cursor_to_pos(0, 1);
+    engine->print("xy");
+    EXPECT_EQ(terminal.row_text(0), "cd      ");
+    EXPECT_EQ(terminal.row_text(1), "xy      ");
+
+    engine->draw_text(0, 2, "z");
+    engine->present();
+    EXPECT_EQ(engine->get_last_frame_stats().cells_changed, 1u);
+    EXPECT_EQ(terminal.row_text(2), "z       ");
+    engine->set_render_thread(false);
+}
+
+TEST(OutputBacklogTest, DrainRateFromQueueAndBlockedWrites) {
+    using namespace std::chrono_literals;
+    size_t queued = 0;
+    OutputBacklog backlog([&] { return queued; });
+    auto start = OutputBacklog::Clock::now();
+    EXPECT_EQ(backlog.estimate_delay(), 0ns);
+
+    queued = 1000;
+    backlog.after_write(1000, start, start);
+    // За 100 мс очередь убыла на 500 байтов
+    queued = 500;
+    backlog.before_write(start + 100ms);
+    EXPECT_DOUBLE_EQ(backlog.get_drain_rate(), 5000.0);
+    queued = 1000;
+    EXPECT_EQ(backlog.estimate_delay(), 200ms);
+
+    // write ждал 100 мс, пока в очереди освободится место под 1000 байтов
+    backlog.after_write(1000, start + 100ms, start + 200ms);
+    EXPECT_DOUBLE_EQ(backlog.get_drain_rate(), 5000.0 + 0.3 * 5000.0);
+}
+
+TEST_F(ConsoleEngineTest, SlowTerminalGetsOnlyLatestFrame) {
+    using namespace std::chrono_literals;
+    size_t queued = 1000;
+    OutputBacklog backlog([&] { return queued; });
+    auto start = OutputBacklog::Clock::now();
+    backlog.after_write(1000, start, start);
+    queued = 500;
+    backlog.before_write(start + 500ms);
+    ASSERT_DOUBLE_EQ(backlog.get_drain_rate(), 1000.0);
+
+    queued = 0;
+    engine->set_output_backlog(std::move(backlog));
+    engine->resize_frame(2, 1);
+    engine->draw_text(0, 0, "ab");
+    engine->present();
+
+    // Очередь на секунду вывода: кадр не отправляется
+    queued = 1000;
+    engine->draw_text(0, 0, "cd");
+    clear_out();
+    engine->present();
+    EXPECT_EQ(out.str(), "");
+    EXPECT_EQ(engine->get_dropped_frames(), 1u);
+
+    // Очередь разобрана: уходит разница с последним отправленным кадром
+    queued = 0;
+    engine->draw_text(0, 0, "ad");
+    engine->present();
+    EXPECT_EQ(out.str(), "\033[1;2Hd");
+}
+
+#ifndef _WIN32
+class SpectatorTest : public ConsoleEngineTest {
+  protected:
+    std::string path = ::testing::TempDir() + "console_engine_spectators.sock";
+    std::vector<int> clients;
+
+    void TearDown() override {
+        engine->stop_spectators();
+        for (int fd : clients) close(fd);
+    }
+
+    int connect_client() {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, path.c_str());
+        EXPECT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&address),
+                          sizeof(address)),
+                  0);
+        clients.push_back(fd);
+        size_t expected = clients.size();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (engine->get_spectator_count() < expected &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        EXPECT_EQ(engine->get_spectator_count(), expected);
+        return fd;
+    }
+
+    // Читает, пока данные приходят чаще, чем раз в timeout_ms
+    static std::string read_all(int fd, int timeout_ms = 200) {
+        std::string result;
+        pollfd entry{fd, POLLIN, 0};
+        char buffer[4096];
+        while (poll(&entry, 1, timeout_ms) > 0) {
+            ssize_t count = read(fd, buffer, sizeof(buffer));
+            if (count <= 0) break;
+            result.append(buffer, count);
+        }
+        return result;
+    }
+
+    static size_t count_of(const std::string& text, const std::string& part) {
+        size_t count = 0;
+        for (size_t pos = text.find(part); pos != std::string::npos;
+             pos = text.find(part, pos + 1)) {
+            ++count;
+        }
+        return count;
+    }
+};
+
+TEST_F(SpectatorTest, LateJoinerGetsKeyframeThenDiffs) {
+    engine->resize_frame(2, 1);
+    engine->draw_text(0, 0, "ab");
+    engine->present();
+    ASSERT_TRUE(engine->start_spectators(path));
+    int first = connect_client();
+
+    engine->draw_text(0, 0, "ad");
+    engine->present();
+    EXPECT_EQ(read_all(first), "\033[0m\033[2J\033[1;1Had\033[0m");
+
+    int second = connect_client();
+    clear_out();
+    engine->draw_text(0, 0, "cd", Color256{9});
+    engine->present();
+    // Старый зритель получает ровно то же, что терминал, новый — весь экран
+    EXPECT_EQ(read_all(first), out.str());
+    EXPECT_EQ(read_all(second),
+              "\033[0m\033[2J\033[1;1H\033[0;38;5;9mcd\033[0m");
+}
+
+// Экран не меняется, а кадры идут: каждый новый зритель всё равно должен
+// получить полный кадр, даже если подключился посреди publish
+TEST_F(SpectatorTest, JoinerDuringStaticFramesGetsKeyframe) {
+    engine->resize_frame(2, 1);
+    engine->draw_text(0, 0, "ab");
+    engine->present();
+    ASSERT_TRUE(engine->start_spectators(path));
+    std::atomic<bool> running{true};
+    std::thread presenter([&] {
+        while (running.load()) engine->present();
+    });
+    for (int i = 0; i < 20; ++i) {
+        int fd = connect_client();
+        std::string received;
+        pollfd entry{fd, POLLIN, 0};
+        char buffer[256];
+        while (received.find("ab") == std::string::npos &&
+               poll(&entry, 1, 2000) > 0) {
+            ssize_t count = read(fd, buffer, sizeof(buffer));
+            if (count <= 0) break;
+            received.append(buffer, count);
+        }
+        EXPECT_EQ(received, "\033[0m\033[2J\033[1;1Hab\033[0m")
+            << "spectator " << i;
+    }
+    running.store(false);
+    presenter.join();
+}
+
+TEST_F(SpectatorTest, StalledSpectatorDoesNotBlockGame) {
+    engine->resize_frame(200, 100);
+    ASSERT_TRUE(engine->start_spectators(path));
+    int stalled = connect_client();
+    int active = connect_client();
+
+    // Каждый кадр перерисовывается целиком: около 20 КБ, всего ~4 МБ
+    size_t total = 0;
+    std::string diffs;
+    std::string received;
+    for (int frame = 0; frame < 200; ++frame) {
+        engine->invalidate();
+        engine->draw_text(0, 0, std::to_string(frame));
+        clear_out();
+        engine->present();
+        total += out.str().size();
+        // Первый кадр новый зритель получает целиком вместо разницы
+        if (frame > 0) diffs += out.str();
+        received += read_all(active, 0);
+    }
+    received += read_all(active);
+    ASSERT_GT(received.size(), diffs.size());
+    EXPECT_EQ(received.substr(received.size() - diffs.size()), diffs);
+    EXPECT_EQ(count_of(received, "\033[2J"), 1u);
+
+    // Застрявший зритель отстал: его очередь сброшена, и он получил полный
+    // кадр заново вместо части пропущенных
+    std::string stalled_received = read_all(stalled);
+    EXPECT_LT(stalled_received.size(), total);
+    EXPECT_GE(count_of(stalled_received, "\033[2J"), 2u);
+    EXPECT_EQ(engine->get_spectator_count(), 2u);
+}
+#endif
+
+TEST_F(ConsoleEngineTest, OverlayIsRemovedByRepaintingOnlyItsRect) {
+    engine->resize_frame(4, 2);
+    engine->draw_text(0, 0, "abcd");
+    engine->draw_text(0, 1, "efgh");
+    engine->set_layer(Layer::Actor);
+    engine->draw_cell(2, 1, ScreenCell{'@'});
+    engine->present();
+    clear_out();
+
+    engine->set_layer(Layer::Overlay);
+    engine->draw_text(1, 0, "XY");
+    engine->draw_text(1, 1, "ZW");
+    // Под меню меняется земля: на экране её не видно
+    engine->set_layer(Layer::Terrain);
+    engine->draw_cell(1, 0, ScreenCell{'q'});
+    engine->present();
+    EXPECT_EQ(out.str(), "\033[1;2HXY\033[2;2HZW");
+    clear_out();
+
+    engine->clear_layer(Layer::Overlay, ClipRect{1, 0, 2, 2});
+    engine->present();
+    EXPECT_EQ(out.str(), "\033[1;2Hqc\033[2;2Hf@");
+    clear_out();
+
+    engine->clear_layer(Layer::Actor, ClipRect{2, 1, 1, 1});
+    engine->present();
+    EXPECT_EQ(out.str(), "\033[2;3Hg");
+}
+
+TEST(SessionLogTest, RecordedSessionReplaysOnHeadlessTerminal) {
+    std::string path = ::testing::TempDir() + "console_engine_session.log";
+    std::istringstream in("wd");
+    std::ostringstream out;
+    // Вывод при уничтожении движка уже не пишется в журнал
+    std::string recorded;
+    {
+        ConsoleEngine engine(in, out);
+        engine.resize_frame(4, 2);
+        ASSERT_TRUE(engine.start_recording(path));
+        engine.draw_text(0, 0, "ab");
+        engine.draw_text(0, 1, "cd", Color256{9});
+        engine.present();
+        EXPECT_EQ(engine.get_no_wait(), 'w');
+        EXPECT_EQ(engine.get_no_wait(), 'd');
+        engine.set_terminal_size(TerminalSize{5, 3});
+        engine.draw_cell(3, 1, ScreenCell{'#'});
+        engine.present();
+        engine.stop_recording();
+        recorded = out.str();
+    }
+
+    SessionReader reader;
+    ASSERT_TRUE(reader.open(path));
+    std::vector<SessionEvent::Type> types;
+    std::string output;
+    std::chrono::microseconds time{0};
+    while (auto event = reader.next()) {
+        types.push_back(event->type);
+        if (event->type == SessionEvent::Type::Output) output += event->data;
+        EXPECT_GE(event->time, time);
+        time = event->time;
+    }
+    using Type = SessionEvent::Type;
+    EXPECT_EQ(types, (std::vector<Type>{Type::Resize, Type::Output, Type::Flush,
+                                        Type::Key, Type::Key, Type::Resize,
+                                        Type::Output, Type::Flush}));
+    EXPECT_EQ(output, recorded);
+
+    SessionReplayer replayer;
+    ASSERT_TRUE(replayer.open(path));
+    SessionReplayer::Result result =
+        replayer.play(SessionReplayer::Pace::Max);
+    EXPECT_EQ(result.outputs, 2u);
+    EXPECT_EQ(result.keys, 2u);
+    EXPECT_EQ(result.resizes, 1u);
+    const HeadlessTerminal& terminal = replayer.get_terminal();
+    EXPECT_EQ(terminal.get_frame_count(), 2u);
+    EXPECT_EQ(terminal.get_totals().bytes, recorded.size());
+    EXPECT_EQ(terminal.row_text(0), "ab   ");
+    EXPECT_EQ(terminal.row_text(1), "cd # ");
+    EXPECT_EQ(terminal.at(0, 1).text_color, Color256{9});
+}
+
+TEST(SessionLogTest, CorruptRecordLengthEndsLog) {
+    std::string path = ::testing::TempDir() + "console_engine_corrupt.log";
+    auto read_all = [&](std::string_view records) {
+        {
+            std::ofstream file(path, std::ios::binary);
+            file << SessionReader::magic << records;
+        }
+        SessionReader reader;
+        EXPECT_TRUE(reader.open(path));
+        std::vector<std::string> outputs;
+        while (auto event = reader.next()) outputs.push_back(event->data);
+        return outputs;
+    };
+    using namespace std::string_view_literals;
+    // Целая запись вывода "ab", затем запись с длиной около 2^63
+    EXPECT_EQ(read_all("\x01\x00\x02"
+                       "ab"
+                       "\x01\x00\xff\xff\xff\xff\xff\xff\xff\xff\x7f"sv),
+              std::vector<std::string>{"ab"});
+    // Длина больше, чем осталось в файле
+    EXPECT_EQ(read_all("\x01\x00\x02"
+                       "ab"
+                       "\x01\x00\x64"
+                       "xyz"sv),
+              std::vector<std::string>{"ab"});
+}
+
+TEST(GameOptionsTest, ParsesSharedFlags) {
+    auto parse = [](std::vector<std::string> args, std::ostream& err) {
+        std::vector<char*> argv{const_cast<char*>("game")};
+        for (std::string& arg : args) argv.push_back(arg.data());
+        return GameOptions::parse(static_cast<int>(argv.size()), argv.data(),
+                                  err);
+    };
+    std::ostringstream err;
+    auto options = parse({"-headless=250", "-stats=out.csv", "-overlay",
+                          "-spectate=/tmp/s", "-record=game.log", "-x"},
+                         err);
+    ASSERT_TRUE(options.has_value());
+    EXPECT_EQ(options->headless_frames, 250);
+    EXPECT_EQ(options->stats.csv_path, "out.csv");
+    EXPECT_TRUE(options->stats.overlay);
+    EXPECT_EQ(options->spectate_path, "/tmp/s");
+    EXPECT_EQ(options->record_path, "game.log");
+    EXPECT_EQ(parse({"-headless"}, err)->headless_frames, 1000);
+    EXPECT_FALSE(parse({}, err)->headless_frames.has_value());
+    EXPECT_TRUE(err.str().empty());
+
+    // Опечатка в числе — подсказка по ключам, а не исключение
+    for (std::string bad : {"-headless=abc", "-headless=12x", "-headless=",
+                            "-headless=-5", "-headless=99999999999"}) {
+        std::ostringstream bad_err;
+        EXPECT_FALSE(parse({bad}, bad_err).has_value()) << bad;
+        EXPECT_NE(bad_err.str().find("-headless[=N]"), std::string::npos);
+    }
+}
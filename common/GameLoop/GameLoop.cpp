@@ -0,0 +1,136 @@
+#include "GameLoop.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/timerfd.h>
+#endif
+
+GameLoop::GameLoop(Clock::duration tick_period) : tick_period_(tick_period) {
+#ifdef __linux__
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+#endif
+}
+
+GameLoop::~GameLoop() {
+#ifndef _WIN32
+    if (timer_fd_ != -1) close(timer_fd_);
+#endif
+}
+
+void GameLoop::set_input_fd(int fd) { input_fd_ = fd; }
+void GameLoop::set_paced(bool paced) { paced_ = paced; }
+
+void GameLoop::on_input(std::function<void()> handler) {
+    input_handler_ = std::move(handler);
+}
+void GameLoop::on_tick(std::function<void()> handler) {
+    tick_handler_ = std::move(handler);
+}
+void GameLoop::on_render(std::function<void()> handler) {
+    render_handler_ = std::move(handler);
+}
+
+void GameLoop::request_render() { render_requested_ = true; }
+void GameLoop::stop() { running_ = false; }
+
+uint64_t GameLoop::get_tick_count() const { return tick_count_; }
+uint64_t GameLoop::get_skipped_ticks() const { return skipped_ticks_; }
+
+void GameLoop::run(int max_ticks) {
+    running_ = true;
+    render_requested_ = true;
+    uint64_t ticks_left = max_ticks < 0 ? UINT64_MAX : max_ticks;
+    auto next_tick = Clock::now() + tick_period_;
+    render();
+    while (running_ && ticks_left > 0) {
+        if (!paced_) {
+            if (input_handler_) input_handler_();
+            if (tick_handler_) tick_handler_();
+            ++tick_count_;
+            --ticks_left;
+            render_requested_ = true;
+            render();
+            continue;
+        }
+
+        if (wait_until(next_tick) && input_handler_) input_handler_();
+
+        auto now = Clock::now();
+        if (now >= next_tick) {
+            // Шаги, которые должны были пройти к этому моменту
+            uint64_t due = (now - next_tick) / tick_period_ + 1;
+            next_tick += static_cast<Clock::rep>(due) * tick_period_;
+            uint64_t ticks = std::min<uint64_t>(
+                {due, static_cast<uint64_t>(max_catch_up_ticks), ticks_left});
+            skipped_ticks_ += due - ticks;
+            for (uint64_t i = 0; i < ticks && running_; ++i) {
+                if (tick_handler_) tick_handler_();
+                ++tick_count_;
+                --ticks_left;
+            }
+            render_requested_ = true;
+        }
+        render();
+    }
+    running_ = false;
+}
+
+void GameLoop::render() {
+    if (!render_requested_) return;
+    render_requested_ = false;
+    if (render_handler_) render_handler_();
+}
+
+#ifdef _WIN32
+bool GameLoop::wait_until(Clock::time_point deadline) {
+    auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline -
+                                                             Clock::now());
+    DWORD timeout = static_cast<DWORD>(std::max<long long>(0, left.count()));
+    if (input_fd_ == -1) {
+        Sleep(timeout);
+        return false;
+    }
+    return WaitForSingleObject(GetStdHandle(STD_INPUT_HANDLE), timeout) ==
+           WAIT_OBJECT_0;
+}
+#else
+bool GameLoop::wait_until(Clock::time_point deadline) {
+    using namespace std::chrono;
+    pollfd fds[2] = {{timer_fd_, POLLIN, 0}, {input_fd_, POLLIN, 0}};
+    int timeout = -1;
+    if (timer_fd_ != -1) {
+#ifdef __linux__
+        // steady_clock в Linux идёт по CLOCK_MONOTONIC
+        auto since_epoch = deadline.time_since_epoch();
+        auto whole = duration_cast<seconds>(since_epoch);
+        itimerspec spec{};
+        spec.it_value.tv_sec = whole.count();
+        spec.it_value.tv_nsec =
+            duration_cast<nanoseconds>(since_epoch - whole).count();
+        if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+            spec.it_value.tv_nsec = 1;
+        timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+#endif
+    } else {
+        // Без timerfd точность ожидания — миллисекунда
+        auto left = ceil<milliseconds>(deadline - Clock::now());
+        timeout = static_cast<int>(std::max<long long>(0, left.count()));
+        fds[0].fd = -1;
+    }
+    if (poll(fds, 2, timeout) <= 0) return false;
+    if (fds[0].revents & POLLIN) {
+        uint64_t expirations;
+        [[maybe_unused]] auto result =
+            read(timer_fd_, &expirations, sizeof(expirations));
+    }
+    return fds[1].revents & POLLIN;
+}
+#endif
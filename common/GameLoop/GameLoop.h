@@ -0,0 +1,60 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+// Цикл игры с фиксированным шагом симуляции. Ввод и таймер ожидаются вместе
+// (poll + timerfd), поэтому нажатие обрабатывается сразу, а в простое цикл
+// не тратит процессор. Если цикл опоздал, пропущенные шаги догоняются (не
+// больше max_catch_up_ticks), а кадр после них рисуется один раз
+class GameLoop {
+  public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int max_catch_up_ticks = 5;
+
+    explicit GameLoop(Clock::duration tick_period);
+    GameLoop(const GameLoop&) = delete;
+    GameLoop& operator=(const GameLoop&) = delete;
+    ~GameLoop();
+
+    // Дескриптор, готовый к чтению, пока есть непрочитанный ввод. Обработчик
+    // ввода должен его прочитать, иначе цикл будет просыпаться снова
+    void set_input_fd(int fd);
+    // Без темпа шаги идут подряд без ожидания: для запуска без терминала
+    void set_paced(bool paced);
+    // Ввод из движка консоли; без терминала кадры идут без пауз, на полной
+    // скорости. Шаблон, чтобы цикл не зависел от библиотеки движка
+    template <typename Engine>
+    void attach_engine(Engine& engine) {
+        set_input_fd(engine.get_input_fd());
+        set_paced(engine.has_terminal());
+    }
+
+    void on_input(std::function<void()> handler);
+    void on_tick(std::function<void()> handler);
+    void on_render(std::function<void()> handler);
+
+    void request_render();
+    void stop();
+    // max_ticks < 0 — до вызова stop()
+    void run(int max_ticks = -1);
+
+    uint64_t get_tick_count() const;
+    uint64_t get_skipped_ticks() const;
+
+  private:
+    bool wait_until(Clock::time_point deadline);
+    void render();
+
+    Clock::duration tick_period_;
+    int input_fd_ = -1;
+    int timer_fd_ = -1;
+    bool paced_ = true;
+    bool running_ = false;
+    bool render_requested_ = false;
+    uint64_t tick_count_ = 0;
+    uint64_t skipped_ticks_ = 0;
+    std::function<void()> input_handler_;
+    std::function<void()> tick_handler_;
+    std::function<void()> render_handler_;
+};
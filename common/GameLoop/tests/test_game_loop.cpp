@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "GameLoop.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace std::chrono_literals;
+
+TEST(GameLoopTest, UnpacedLoopRunsTicksBackToBack) {
+    GameLoop loop(1h);
+    loop.set_paced(false);
+    int inputs = 0;
+    int ticks = 0;
+    int renders = 0;
+    loop.on_input([&] { ++inputs; });
+    loop.on_tick([&] { ++ticks; });
+    loop.on_render([&] { ++renders; });
+    loop.run(10);
+
+    EXPECT_EQ(ticks, 10);
+    EXPECT_EQ(inputs, 10);
+    // Начальный кадр и кадр после каждого шага
+    EXPECT_EQ(renders, 11);
+    EXPECT_EQ(loop.get_tick_count(), 10u);
+}
+
+TEST(GameLoopTest, StopEndsLoop) {
+    GameLoop loop(1ms);
+    int ticks = 0;
+    loop.on_tick([&] {
+        if (++ticks == 3) loop.stop();
+    });
+    loop.run();
+    EXPECT_EQ(ticks, 3);
+}
+
+TEST(GameLoopTest, CatchUpTicksShareOneFrame) {
+    GameLoop loop(5ms);
+    int ticks = 0;
+    int renders = 0;
+    loop.on_tick([&] {
+        // Первый шаг задерживает цикл на десяток периодов
+        if (++ticks == 1) std::this_thread::sleep_for(60ms);
+        if (ticks == 1 + GameLoop::max_catch_up_ticks) loop.stop();
+    });
+    loop.on_render([&] { ++renders; });
+    loop.run();
+
+    EXPECT_EQ(ticks, 1 + GameLoop::max_catch_up_ticks);
+    EXPECT_EQ(renders, 3);
+    EXPECT_GT(loop.get_skipped_ticks(), 0u);
+}
+
+#ifndef _WIN32
+TEST(GameLoopTest, InputWakesLoopBeforeTick) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    GameLoop loop(10s);
+    loop.set_input_fd(fds[0]);
+    auto written_at = GameLoop::Clock::now();
+    std::thread writer([&] {
+        std::this_thread::sleep_for(20ms);
+        written_at = GameLoop::Clock::now();
+        char c = 'a';
+        ASSERT_EQ(write(fds[1], &c, 1), 1);
+    });
+    GameLoop::Clock::time_point handled_at;
+    loop.on_input([&] {
+        char c;
+        ASSERT_EQ(read(fds[0], &c, 1), 1);
+        handled_at = GameLoop::Clock::now();
+        loop.stop();
+    });
+    loop.run();
+    writer.join();
+    close(fds[0]);
+    close(fds[1]);
+
+    EXPECT_EQ(loop.get_tick_count(), 0u);
+    EXPECT_LT(handled_at - written_at, 50ms);
+}
+#endif
+
+// Движок без терминала: цикл берёт его ввод и идёт без пауз
+TEST(GameLoopTest, EngineWithoutTerminalRunsUnpaced) {
+    struct HeadlessEngine {
+        int get_input_fd() { return -1; }
+        bool has_terminal() const { return false; }
+    } engine;
+    GameLoop loop(1h);
+    loop.attach_engine(engine);
+    int ticks = 0;
+    loop.on_tick([&] { ++ticks; });
+    loop.run(3);
+    EXPECT_EQ(ticks, 3);
+}